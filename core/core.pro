@@ -0,0 +1,8 @@
+# Static library for headless consumers that don't use Qt at run time
+TARGET = gpsdcore
+CONFIG -= qt
+CONFIG += staticlib c++11
+
+TEMPLATE = lib
+
+include(gpsdcore.pri)
@@ -0,0 +1,173 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdclient.h"
+
+#include "gpsdjson.h"
+
+#include <time.h>
+
+GpsdClient::GpsdClient(Mode mode)
+    : _mode(mode)
+    , _receivedAt(0)
+{
+}
+
+bool GpsdClient::open(const std::string& hostname, uint16_t port,
+                      const std::string& device, int timeout)
+{
+    close();
+    if(!_transport.open(hostname, port, timeout))
+        return false;
+    if(!_transport.send(GpsdJson::watchCommand(true, _mode == JsonMode, device)))
+    {
+        _transport.close();
+        return false;
+    }
+    return true;
+}
+
+void GpsdClient::close()
+{
+    _transport.close();
+    _framer.clear();
+    _epochAssembler.reset();
+    _skyAssembler.reset();
+}
+
+bool GpsdClient::isOpen() const
+{
+    return _transport.isOpen();
+}
+
+int GpsdClient::fd() const
+{
+    return _transport.fd();
+}
+
+int GpsdClient::dispatch(Handler* handler)
+{
+    // lines left over by readRecords() go first, with the stamp of the
+    // read that brought them
+    int count = dispatchLines(handler);
+    if(receive() < 0)
+        return count > 0 ? count : -1;
+    return count + dispatchLines(handler);
+}
+
+int GpsdClient::readRecords(Record* records, int maxRecords)
+{
+    int count = readLines(records, maxRecords);
+    if(count == maxRecords)
+        return count;
+    if(receive() < 0)
+        return count > 0 ? count : -1;
+    return count + readLines(records + count, maxRecords - count);
+}
+
+int64_t GpsdClient::monotonicNsecs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+int GpsdClient::receive()
+{
+    int got = _transport.read(&_framer);
+    if(got < 0)
+    {
+        close();
+        return -1;
+    }
+    // the complete lines of earlier reads are all handed out by now, so
+    // the stamp only goes to lines completed by this read
+    if(got > 0)
+        _receivedAt = monotonicNsecs();
+    return got;
+}
+
+int GpsdClient::dispatchLines(Handler* handler)
+{
+    // one record is reused for all lines
+    int count = 0;
+    const char* line = 0;
+    int size = 0;
+    while(_framer.nextLine(&line, &size))
+    {
+        if(!decodeLine(line, size, &_record))
+            continue;
+        if(_record.type == Record::Sky)
+            handler->skyReceived(_record.sky, _record.receivedAt);
+        else
+            handler->fixReceived(_record.fix, _record.receivedAt);
+        ++count;
+    }
+    return count;
+}
+
+int GpsdClient::readLines(Record* records, int maxRecords)
+{
+    int count = 0;
+    const char* line = 0;
+    int size = 0;
+    while(count < maxRecords && _framer.nextLine(&line, &size))
+        count += decodeLine(line, size, &records[count]);
+    return count;
+}
+
+int GpsdClient::decodeLine(const char* line, int size, Record* record)
+{
+    record->receivedAt = _receivedAt;
+    if(_mode == JsonMode)
+    {
+        if(GpsdJson::decodeTPV(line, size, &record->fix))
+        {
+            record->type = Record::Fix;
+            return 1;
+        }
+        if(GpsdJson::decodeSKY(line, size, &record->sky))
+        {
+            record->type = Record::Sky;
+            return 1;
+        }
+        return 0;
+    }
+
+    if(_epochAssembler.addSentence(line, size, _receivedAt, &record->fix))
+    {
+        record->type = Record::Fix;
+        record->receivedAt = _epochAssembler.completedReceivedAt();
+        return 1;
+    }
+    if(_skyAssembler.addSentence(line, size, _receivedAt) & GpsdSkyAssembler::SkyCompleted)
+    {
+        record->type = Record::Sky;
+        record->sky = _skyAssembler.sky();
+        record->receivedAt = _skyAssembler.skyReceivedAt();
+        return 1;
+    }
+    return 0;
+}
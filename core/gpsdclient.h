@@ -0,0 +1,111 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDCLIENT_H
+#define GPSDCLIENT_H
+
+#include "gpsdepochassembler.h"
+#include "gpsdlineframer.h"
+#include "gpsdskyassembler.h"
+#include "gpsdtransport.h"
+
+// Connection to gpsd for programs running their own poll(2) or epoll(7)
+// loop instead of a Qt event loop. Watch fd() for input and call either
+// dispatch() or readRecords() on every wakeup; both drain everything that
+// is pending in one batch and allocate nothing once the receive buffer
+// has grown to the size of a typical read.
+class GpsdClient
+{
+public:
+    enum Mode
+    {
+        NmeaMode,   // decode NMEA sentences, merged per receiver epoch
+        JsonMode    // decode gpsd TPV and SKY reports
+    };
+
+    class Handler
+    {
+    public:
+        virtual ~Handler() {}
+        virtual void fixReceived(const GpsdFix& fix, int64_t receivedAt) = 0;
+        virtual void skyReceived(const GpsdSky& sky, int64_t receivedAt) = 0;
+    };
+
+    struct Record
+    {
+        enum Type
+        {
+            Fix,
+            Sky
+        };
+
+        Type type;
+        int64_t receivedAt;     // CLOCK_MONOTONIC in ns
+        GpsdFix fix;            // valid for Fix records
+        GpsdSky sky;            // valid for Sky records
+    };
+
+    explicit GpsdClient(Mode mode = JsonMode);
+
+    // Connects and enables reports, from one device only unless device is
+    // empty, waiting at most timeout ms.
+    bool open(const std::string& hostname = "localhost", uint16_t port = 2947,
+              const std::string& device = std::string(), int timeout = 1000);
+    void close();
+    bool isOpen() const;
+    int fd() const;
+
+    // Reads and decodes everything pending and hands each record to
+    // handler. Returns the number of records, or -1 if the connection was
+    // lost; records read before the loss are returned first.
+    int dispatch(Handler* handler);
+
+    // Same as dispatch(), but stores the records in the given array. If it
+    // is filled up, the rest stays buffered and readRecords() must be
+    // called again before waiting for fd() to become readable. Buffered
+    // lines are handed out before anything new is read.
+    int readRecords(Record* records, int maxRecords);
+
+    static int64_t monotonicNsecs();
+
+private:
+    GpsdClient(const GpsdClient&);
+    GpsdClient& operator=(const GpsdClient&);
+
+    int receive();
+    int dispatchLines(Handler* handler);
+    int readLines(Record* records, int maxRecords);
+    int decodeLine(const char* line, int size, Record* record);
+
+    Mode _mode;
+    GpsdTransport _transport;
+    GpsdLineFramer _framer;
+    GpsdEpochAssembler _epochAssembler;
+    GpsdSkyAssembler _skyAssembler;
+    int64_t _receivedAt;
+    Record _record;
+};
+
+#endif // GPSDCLIENT_H
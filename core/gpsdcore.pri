@@ -0,0 +1,37 @@
+# Qt-free gpsd client core, shared by the plugin and core.pro
+CONFIG += c++11
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+HEADERS += \
+    $$PWD/gpsdepochassembler.h \
+    $$PWD/gpsdfix.h \
+    $$PWD/gpsdjson.h \
+    $$PWD/gpsdlineframer.h \
+    $$PWD/gpsdnmea.h \
+    $$PWD/gpsdscenario.h \
+    $$PWD/gpsdskyassembler.h
+
+SOURCES += \
+    $$PWD/gpsdepochassembler.cpp \
+    $$PWD/gpsdfix.cpp \
+    $$PWD/gpsdjson.cpp \
+    $$PWD/gpsdlineframer.cpp \
+    $$PWD/gpsdnmea.cpp \
+    $$PWD/gpsdscenario.cpp \
+    $$PWD/gpsdskyassembler.cpp
+
+unix {
+HEADERS += \
+    $$PWD/gpsdclient.h \
+    $$PWD/gpsdlogformat.h \
+    $$PWD/gpsdlogreader.h \
+    $$PWD/gpsdrecorder.h \
+    $$PWD/gpsdtransport.h
+
+SOURCES += \
+    $$PWD/gpsdclient.cpp \
+    $$PWD/gpsdlogreader.cpp \
+    $$PWD/gpsdrecorder.cpp \
+    $$PWD/gpsdtransport.cpp
+}
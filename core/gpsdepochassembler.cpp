@@ -0,0 +1,183 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdepochassembler.h"
+
+#include "gpsdnmea.h"
+
+#include <cmath>
+
+namespace
+{
+
+void mergeValue(double value, double* target)
+{
+    if(!std::isnan(value))
+        *target = value;
+}
+
+}
+
+GpsdEpochAssembler::GpsdEpochAssembler()
+    : _epochTime(-1)
+    , _epochDone(false)
+    , _epochReceivedAt(0)
+    , _completedReceivedAt(0)
+    , _seen(0)
+    , _expected(0)
+    , _rejected(false)
+{
+}
+
+GpsdEpochAssembler::SentenceType GpsdEpochAssembler::sentenceType(const char* data, int size)
+{
+    if(GpsdNmea::isSentence(data, size, "RMC"))
+        return RMC;
+    if(GpsdNmea::isSentence(data, size, "GGA"))
+        return GGA;
+    if(GpsdNmea::isSentence(data, size, "GLL"))
+        return GLL;
+    if(GpsdNmea::isSentence(data, size, "VTG"))
+        return VTG;
+    if(GpsdNmea::isSentence(data, size, "GST"))
+        return GST;
+    return UnknownSentence;
+}
+
+bool GpsdEpochAssembler::addSentence(const char* data, int size, int64_t receivedAt,
+                                     GpsdFix* epoch)
+{
+    _rejected = false;
+    SentenceType type = sentenceType(data, size);
+    GpsdFix update;
+    if(type == UnknownSentence)
+        return false;
+    if(!GpsdNmea::decodePosition(data, size, &update))
+    {
+        _rejected = GpsdNmea::hasValidChecksum(data, size);
+        return false;
+    }
+    return addSentence(type, update, receivedAt, epoch);
+}
+
+bool GpsdEpochAssembler::rejected() const
+{
+    return _rejected;
+}
+
+bool GpsdEpochAssembler::addSentence(SentenceType type, const GpsdFix& update,
+                                     int64_t receivedAt, GpsdFix* epoch)
+{
+    bool completed = false;
+
+    // VTG carries no time and belongs to the epoch in progress
+    if(update.hasTime() && update.timeOfDay != _epochTime)
+    {
+        if(_seen)
+        {
+            _expected = _seen;
+            completed = complete(epoch);
+        }
+        startEpoch(update.timeOfDay);
+    }
+
+    if(!_seen)
+        _epochReceivedAt = receivedAt;
+
+    // late sentences of an epoch that was already completed are dropped,
+    // but their type is expected from the next epoch on
+    _seen |= type;
+    if(_epochDone)
+        return completed;
+
+    merge(update);
+
+    if(!completed && _expected && (_seen & _expected) == _expected)
+        completed = complete(epoch);
+    return completed;
+}
+
+bool GpsdEpochAssembler::flush(GpsdFix* epoch)
+{
+    return _seen && complete(epoch);
+}
+
+void GpsdEpochAssembler::reset()
+{
+    startEpoch(-1);
+    _expected = 0;
+}
+
+int64_t GpsdEpochAssembler::completedReceivedAt() const
+{
+    return _completedReceivedAt;
+}
+
+void GpsdEpochAssembler::startEpoch(int timeOfDay)
+{
+    _epoch.clear();
+    _epochTime = timeOfDay;
+    _epochDone = false;
+    _seen = 0;
+}
+
+void GpsdEpochAssembler::merge(const GpsdFix& update)
+{
+    // GGA provides the altitude, RMC and GLL only 2D positions
+    if(update.hasPosition())
+    {
+        _epoch.latitude = update.latitude;
+        _epoch.longitude = update.longitude;
+        mergeValue(update.altitude, &_epoch.altitude);
+    }
+
+    if(update.hasDate() && update.hasTime())
+    {
+        _epoch.year = update.year;
+        _epoch.month = update.month;
+        _epoch.day = update.day;
+        _epoch.timeOfDay = update.timeOfDay;
+    }
+    else if(update.hasTime() && !_epoch.hasDate())
+        _epoch.timeOfDay = update.timeOfDay;
+
+    mergeValue(update.speed, &_epoch.speed);
+    mergeValue(update.course, &_epoch.course);
+    mergeValue(update.climb, &_epoch.climb);
+    mergeValue(update.magneticVariation, &_epoch.magneticVariation);
+    mergeValue(update.horizontalAccuracy, &_epoch.horizontalAccuracy);
+    mergeValue(update.verticalAccuracy, &_epoch.verticalAccuracy);
+    _epoch.hasFix = _epoch.hasFix || update.hasFix;
+}
+
+bool GpsdEpochAssembler::complete(GpsdFix* epoch)
+{
+    if(_epochDone || !_epoch.hasPosition())
+        return false;
+    _epochDone = true;
+    _completedReceivedAt = _epochReceivedAt;
+    *epoch = _epoch;
+    return true;
+}
@@ -0,0 +1,90 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDEPOCHASSEMBLER_H
+#define GPSDEPOCHASSEMBLER_H
+
+#include "gpsdfix.h"
+
+// Merges the position sentences of one receiver epoch (RMC, GGA, GLL, VTG
+// and GST sharing a UTC time) into a single GpsdFix.
+//
+// An epoch is complete as soon as all sentence types seen in the previous
+// epoch have arrived, or at the latest when a sentence with a new UTC time
+// starts the next one.
+class GpsdEpochAssembler
+{
+public:
+    enum SentenceType
+    {
+        UnknownSentence = 0x00,
+        RMC = 0x01,
+        GGA = 0x02,
+        GLL = 0x04,
+        VTG = 0x08,
+        GST = 0x10
+    };
+
+    GpsdEpochAssembler();
+
+    static SentenceType sentenceType(const char* data, int size);
+
+    // Decodes a position sentence received at receivedAt and adds it to the
+    // current epoch. Returns true if an epoch was completed, which is then
+    // stored in epoch.
+    bool addSentence(const char* data, int size, int64_t receivedAt, GpsdFix* epoch);
+
+    // true if the last sentence passed to the method above was a position
+    // sentence with a valid checksum that could not be decoded
+    bool rejected() const;
+
+    // Adds an already decoded sentence.
+    bool addSentence(SentenceType type, const GpsdFix& update, int64_t receivedAt,
+                     GpsdFix* epoch);
+
+    // Completes the current epoch regardless of missing sentences.
+    bool flush(GpsdFix* epoch);
+
+    void reset();
+
+    // receive time of the first sentence of the last completed epoch
+    int64_t completedReceivedAt() const;
+
+private:
+    void startEpoch(int timeOfDay);
+    void merge(const GpsdFix& update);
+    bool complete(GpsdFix* epoch);
+
+    GpsdFix _epoch;
+    int _epochTime;
+    bool _epochDone;
+    int64_t _epochReceivedAt;
+    int64_t _completedReceivedAt;
+    unsigned int _seen;
+    unsigned int _expected;
+    bool _rejected;
+};
+
+#endif // GPSDEPOCHASSEMBLER_H
@@ -0,0 +1,112 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdfix.h"
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+// days since 1970-01-01 of a proleptic Gregorian date
+int64_t daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yoe = year - era * 400;
+    int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+}
+
+GpsdFix::GpsdFix()
+{
+    clear();
+}
+
+void GpsdFix::clear()
+{
+    year = 0;
+    month = 0;
+    day = 0;
+    timeOfDay = -1;
+    hasFix = false;
+    latitude = NaN;
+    longitude = NaN;
+    altitude = NaN;
+    speed = NaN;
+    course = NaN;
+    climb = NaN;
+    magneticVariation = NaN;
+    horizontalAccuracy = NaN;
+    verticalAccuracy = NaN;
+}
+
+bool GpsdFix::hasPosition() const
+{
+    return !std::isnan(latitude) && !std::isnan(longitude);
+}
+
+bool GpsdFix::hasAltitude() const
+{
+    return !std::isnan(altitude);
+}
+
+bool GpsdFix::hasDate() const
+{
+    return year > 0;
+}
+
+bool GpsdFix::hasTime() const
+{
+    return timeOfDay >= 0;
+}
+
+bool GpsdFix::msecsSinceEpoch(int64_t* msecs) const
+{
+    if(!hasDate() || !hasTime())
+        return false;
+    *msecs = daysFromCivil(year, month, day) * 86400000 + timeOfDay;
+    return true;
+}
+
+GpsdSky::GpsdSky()
+{
+    clear();
+}
+
+void GpsdSky::clear()
+{
+    fixMode = UnknownFix;
+    pdop = NaN;
+    hdop = NaN;
+    vdop = NaN;
+    satelliteCount = 0;
+}
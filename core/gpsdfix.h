@@ -0,0 +1,110 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDFIX_H
+#define GPSDFIX_H
+
+#include <stdint.h>
+
+// Position report of the receiver as decoded from NMEA or gpsd JSON, free
+// of any Qt type. Unknown values are NaN, or as noted.
+struct GpsdFix
+{
+    GpsdFix();
+    void clear();
+
+    bool hasPosition() const;
+    bool hasAltitude() const;
+    bool hasDate() const;
+    bool hasTime() const;
+
+    // UTC ms since 1970-01-01, only if both date and time are known
+    bool msecsSinceEpoch(int64_t* msecs) const;
+
+    int year;                   // 0 if unknown
+    int month;
+    int day;
+    int timeOfDay;              // UTC ms since midnight, -1 if unknown
+    bool hasFix;
+
+    double latitude;            // degrees
+    double longitude;           // degrees
+    double altitude;            // m above mean sea level
+    double speed;               // m/s over ground
+    double course;              // degrees from true north
+    double climb;               // m/s
+    double magneticVariation;   // degrees, negative towards west
+    double horizontalAccuracy;  // m
+    double verticalAccuracy;    // m
+};
+
+// One satellite of a sky view, identified by its system and PRN.
+struct GpsdSatellite
+{
+    enum System
+    {
+        UnknownSystem = 0,
+        Gps,
+        Sbas,
+        Glonass,
+        Galileo,
+        Beidou,
+        Qzss,
+        Navic
+    };
+
+    int prn;
+    System system;
+    int elevation;              // degrees, -1 if unknown
+    int azimuth;                // degrees, -1 if unknown
+    int snr;                    // dB-Hz, -1 if unknown
+    bool used;
+};
+
+// Sky view of one receiver epoch.
+struct GpsdSky
+{
+    enum { MaxSatellites = 128 };
+
+    enum FixMode
+    {
+        UnknownFix = 0,
+        NoFix = 1,
+        Fix2D = 2,
+        Fix3D = 3
+    };
+
+    GpsdSky();
+    void clear();
+
+    FixMode fixMode;
+    double pdop;
+    double hdop;
+    double vdop;
+    int satelliteCount;
+    GpsdSatellite satellites[MaxSatellites];
+};
+
+#endif // GPSDFIX_H
@@ -0,0 +1,291 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdjson.h"
+
+#include "gpsdnmea.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+
+const char* skipSpace(const char* p, const char* end)
+{
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+        ++p;
+    return p;
+}
+
+// end of the string starting at p, after its closing quote
+const char* skipString(const char* p, const char* end)
+{
+    for(++p; p < end; ++p)
+    {
+        if(*p == '\\')
+            ++p;
+        else if(*p == '"')
+            return p + 1;
+    }
+    return 0;
+}
+
+const char* skipValue(const char* p, const char* end)
+{
+    if(p >= end)
+        return 0;
+    if(*p == '"')
+        return skipString(p, end);
+    if(*p == '{' || *p == '[')
+    {
+        int depth = 0;
+        while(p < end)
+        {
+            if(*p == '"')
+            {
+                p = skipString(p, end);
+                if(!p)
+                    return 0;
+                continue;
+            }
+            if(*p == '{' || *p == '[')
+                ++depth;
+            else if(*p == '}' || *p == ']')
+            {
+                if(--depth == 0)
+                    return p + 1;
+            }
+            ++p;
+        }
+        return 0;
+    }
+    while(p < end && *p != ',' && *p != '}' && *p != ']'
+          && *p != ' ' && *p != '\r' && *p != '\n')
+        ++p;
+    return p;
+}
+
+// Value of a member of the object starting at p, without surrounding space.
+bool findMember(const char* p, const char* end, const char* key, GpsdNmea::Field* value)
+{
+    p = skipSpace(p, end);
+    if(p >= end || *p != '{')
+        return false;
+    int keySize = int(strlen(key));
+    p = skipSpace(p + 1, end);
+    while(p < end && *p == '"')
+    {
+        const char* keyEnd = skipString(p, end);
+        if(!keyEnd)
+            return false;
+        bool match = keyEnd - p - 2 == keySize && memcmp(p + 1, key, keySize) == 0;
+        p = skipSpace(keyEnd, end);
+        if(p >= end || *p != ':')
+            return false;
+        p = skipSpace(p + 1, end);
+        const char* valueEnd = skipValue(p, end);
+        if(!valueEnd)
+            return false;
+        if(match)
+        {
+            value->data = p;
+            value->size = int(valueEnd - p);
+            return true;
+        }
+        p = skipSpace(valueEnd, end);
+        if(p >= end || *p != ',')
+            return false;
+        p = skipSpace(p + 1, end);
+    }
+    return false;
+}
+
+bool readDouble(const GpsdNmea::Field& object, const char* key, double* value)
+{
+    GpsdNmea::Field field;
+    return findMember(object.data, object.data + object.size, key, &field)
+            && GpsdNmea::toDouble(field, value);
+}
+
+bool readInt(const GpsdNmea::Field& object, const char* key, int* value)
+{
+    GpsdNmea::Field field;
+    return findMember(object.data, object.data + object.size, key, &field)
+            && GpsdNmea::toInt(field, value);
+}
+
+bool readNumber(const char* p, int size, int* value)
+{
+    GpsdNmea::Field field = { p, size };
+    return GpsdNmea::toInt(field, value);
+}
+
+// "2026-10-16T12:34:56.000Z"
+bool readTime(const GpsdNmea::Field& field, GpsdFix* fix)
+{
+    const char* p = field.data + 1;
+    int size = field.size - 2;
+    if(size < 20 || field.data[0] != '"' || p[4] != '-' || p[7] != '-' || p[10] != 'T'
+            || p[13] != ':' || p[16] != ':' || p[size - 1] != 'Z')
+        return false;
+    int year = 0, month = 0, day = 0, hours = 0, minutes = 0, seconds = 0;
+    if(!readNumber(p, 4, &year) || !readNumber(p + 5, 2, &month) || !readNumber(p + 8, 2, &day)
+            || !readNumber(p + 11, 2, &hours) || !readNumber(p + 14, 2, &minutes)
+            || !readNumber(p + 17, 2, &seconds))
+        return false;
+    if(month < 1 || month > 12 || day < 1 || day > 31 || hours > 23 || minutes > 59 || seconds > 60)
+        return false;
+    int msecs = 0;
+    if(size > 20)
+    {
+        double fraction = 0;
+        GpsdNmea::Field rest = { p + 19, size - 20 };
+        if(p[19] != '.' || !GpsdNmea::toDouble(rest, &fraction))
+            return false;
+        msecs = int(fraction * 1000 + 0.5);
+        if(msecs > 999)
+            msecs = 999;
+    }
+    if(seconds == 60)
+        seconds = 59;
+    fix->year = year;
+    fix->month = month;
+    fix->day = day;
+    fix->timeOfDay = ((hours * 60 + minutes) * 60 + seconds) * 1000 + msecs;
+    return true;
+}
+
+}
+
+namespace GpsdJson
+{
+
+std::string watchCommand(bool enable, bool json, const std::string& device)
+{
+    if(!enable)
+        return "?WATCH={\"enable\": false}\n";
+    std::string command = json ? "?WATCH={\"enable\":true, \"json\":true"
+                               : "?WATCH={\"enable\":true, \"nmea\":true";
+    if(!device.empty())
+        command += ", \"device\":\"" + device + "\"";
+    return command + "}\n";
+}
+
+bool isClass(const char* data, int size, const char* cls)
+{
+    GpsdNmea::Field field;
+    if(!findMember(data, data + size, "class", &field))
+        return false;
+    int clsSize = int(strlen(cls));
+    return field.size == clsSize + 2 && memcmp(field.data + 1, cls, clsSize) == 0;
+}
+
+bool decodeTPV(const char* data, int size, GpsdFix* fix)
+{
+    if(!isClass(data, size, "TPV"))
+        return false;
+    GpsdNmea::Field object = { data, size };
+    fix->clear();
+
+    int mode = 0;
+    fix->hasFix = readInt(object, "mode", &mode) && mode >= 2;
+    GpsdNmea::Field time;
+    if(findMember(data, data + size, "time", &time))
+        readTime(time, fix);
+
+    double latitude = 0, longitude = 0;
+    if(readDouble(object, "lat", &latitude) && readDouble(object, "lon", &longitude))
+    {
+        fix->latitude = latitude;
+        fix->longitude = longitude;
+        // gpsd 3.20 renamed alt to altMSL
+        if(!readDouble(object, "altMSL", &fix->altitude))
+            readDouble(object, "alt", &fix->altitude);
+    }
+    readDouble(object, "speed", &fix->speed);
+    readDouble(object, "track", &fix->course);
+    readDouble(object, "climb", &fix->climb);
+    readDouble(object, "magvar", &fix->magneticVariation);
+
+    double epx = 0, epy = 0;
+    if(!readDouble(object, "eph", &fix->horizontalAccuracy)
+            && readDouble(object, "epx", &epx) && readDouble(object, "epy", &epy))
+        fix->horizontalAccuracy = std::sqrt(epx * epx + epy * epy);
+    readDouble(object, "epv", &fix->verticalAccuracy);
+    return true;
+}
+
+bool decodeSKY(const char* data, int size, GpsdSky* sky)
+{
+    if(!isClass(data, size, "SKY"))
+        return false;
+    GpsdNmea::Field object = { data, size };
+    sky->clear();
+    readDouble(object, "pdop", &sky->pdop);
+    readDouble(object, "hdop", &sky->hdop);
+    readDouble(object, "vdop", &sky->vdop);
+
+    GpsdNmea::Field satellites;
+    if(!findMember(data, data + size, "satellites", &satellites) || satellites.data[0] != '[')
+        return true;
+
+    const char* end = satellites.data + satellites.size - 1;
+    const char* p = skipSpace(satellites.data + 1, end);
+    while(p < end && *p == '{' && sky->satelliteCount < GpsdSky::MaxSatellites)
+    {
+        const char* objectEnd = skipValue(p, end);
+        if(!objectEnd)
+            break;
+        GpsdNmea::Field satellite = { p, int(objectEnd - p) };
+        GpsdSatellite& info = sky->satellites[sky->satelliteCount];
+        double value = 0;
+        if(readInt(satellite, "PRN", &info.prn))
+        {
+            // gnssid as in u-blox UBX, PRNs are unique across systems
+            static const GpsdSatellite::System Systems[] = {
+                GpsdSatellite::Gps, GpsdSatellite::Sbas, GpsdSatellite::Galileo,
+                GpsdSatellite::Beidou, GpsdSatellite::UnknownSystem, GpsdSatellite::Qzss,
+                GpsdSatellite::Glonass, GpsdSatellite::Navic
+            };
+            int gnssId = -1;
+            info.system = readInt(satellite, "gnssid", &gnssId) && gnssId >= 0 && gnssId <= 7
+                    ? Systems[gnssId] : GpsdNmea::prnSystem(info.prn);
+            info.elevation = readDouble(satellite, "el", &value) ? int(std::floor(value + 0.5)) : -1;
+            info.azimuth = readDouble(satellite, "az", &value) ? int(std::floor(value + 0.5)) : -1;
+            info.snr = readDouble(satellite, "ss", &value) ? int(std::floor(value + 0.5)) : -1;
+            GpsdNmea::Field used;
+            info.used = findMember(p, objectEnd, "used", &used)
+                    && used.size == 4 && memcmp(used.data, "true", 4) == 0;
+            ++sky->satelliteCount;
+        }
+        p = skipSpace(objectEnd, end);
+        if(p < end && *p == ',')
+            p = skipSpace(p + 1, end);
+    }
+    return true;
+}
+
+}
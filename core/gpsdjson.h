@@ -0,0 +1,50 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDJSON_H
+#define GPSDJSON_H
+
+#include "gpsdfix.h"
+
+#include <string>
+
+// Decoders for the JSON reports of gpsd, see gpsd_json(5). Only the flat
+// members used here are understood; nothing is allocated.
+namespace GpsdJson
+{
+
+// ?WATCH command enabling NMEA or JSON reports, restricted to one device
+// unless device is empty, or disabling reports.
+std::string watchCommand(bool enable, bool json = false, const std::string& device = std::string());
+
+// true for reports like {"class":"TPV",...} if cls is "TPV"
+bool isClass(const char* data, int size, const char* cls);
+
+bool decodeTPV(const char* data, int size, GpsdFix* fix);
+bool decodeSKY(const char* data, int size, GpsdSky* sky);
+
+}
+
+#endif // GPSDJSON_H
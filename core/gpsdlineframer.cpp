@@ -0,0 +1,101 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdlineframer.h"
+
+#include <cstring>
+
+GpsdLineFramer::GpsdLineFramer(int capacity)
+    : _buffer(capacity)
+    , _start(0)
+    , _end(0)
+{
+}
+
+char* GpsdLineFramer::prepare(int size)
+{
+    // move pending data to the front before growing the buffer
+    if(_end + size > int(_buffer.size()) && _start > 0)
+    {
+        memmove(&_buffer[0], &_buffer[_start], _end - _start);
+        _end -= _start;
+        _start = 0;
+    }
+    if(_end + size > int(_buffer.size()))
+        _buffer.resize(_end + size);
+    return &_buffer[0] + _end;
+}
+
+void GpsdLineFramer::commit(int size)
+{
+    _end += size;
+    if(_end - _start > MaxLineSize && completeSize() == 0)
+        clear();
+}
+
+const char* GpsdLineFramer::data() const
+{
+    return &_buffer[0] + _start;
+}
+
+int GpsdLineFramer::size() const
+{
+    return _end - _start;
+}
+
+int GpsdLineFramer::completeSize() const
+{
+    for(int i = _end - 1; i >= _start; --i)
+    {
+        if(_buffer[i] == '\n')
+            return i + 1 - _start;
+    }
+    return 0;
+}
+
+bool GpsdLineFramer::nextLine(const char** line, int* size)
+{
+    const char* begin = data();
+    const char* newline = static_cast<const char*>(memchr(begin, '\n', _end - _start));
+    if(!newline)
+        return false;
+    *line = begin;
+    *size = int(newline - begin) + 1;
+    consume(*size);
+    return true;
+}
+
+void GpsdLineFramer::consume(int size)
+{
+    _start += size;
+    if(_start >= _end)
+        clear();
+}
+
+void GpsdLineFramer::clear()
+{
+    _start = 0;
+    _end = 0;
+}
@@ -0,0 +1,61 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDLINEFRAMER_H
+#define GPSDLINEFRAMER_H
+
+#include <vector>
+
+// Receive buffer splitting the gpsd stream into lines. Data is written in
+// place: prepare() space, fill it, then commit() what was filled.
+class GpsdLineFramer
+{
+public:
+    explicit GpsdLineFramer(int capacity = 4096);
+
+    char* prepare(int size);
+    void commit(int size);
+
+    // Pending data, of which completeSize() bytes form complete lines.
+    const char* data() const;
+    int size() const;
+    int completeSize() const;
+
+    // Returns the next complete line including its '\n' and consumes it.
+    bool nextLine(const char** line, int* size);
+
+    void consume(int size);
+    void clear();
+
+private:
+    // a line longer than this is garbage and dropped
+    static const int MaxLineSize = 65536;
+
+    std::vector<char> _buffer;
+    int _start;
+    int _end;
+};
+
+#endif // GPSDLINEFRAMER_H
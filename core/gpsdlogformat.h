@@ -0,0 +1,101 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDLOGFORMAT_H
+#define GPSDLOGFORMAT_H
+
+#include <stdint.h>
+
+// Binary log of a raw gpsd stream as written by GpsdRecorder. All numbers
+// are in host byte order.
+//
+//   FileHeader
+//   Entry*        EntryHeader, payload padded to a multiple of 8 bytes
+//   EntryHeader   zeroed, ends the entries
+//   IndexEntry*   sparse time index
+//   Footer
+//
+// Every received line is a LineEntry stamped with its CLOCK_MONOTONIC
+// receive time in ns. The tag tells the connection it came from; the
+// SourceEntry with the same tag precedes its first line and holds the
+// connection's name.
+//
+// The index points to the first line and then to the first line at least
+// IndexInterval after the previous point, in file order. It is written
+// when the recorder is closed; a log that was not closed ends with the
+// zeroed header left by the preallocation and has no index. Version 1
+// logs never have one.
+namespace GpsdLog
+{
+
+const char Magic[8] = { 'G', 'P', 'S', 'D', 'L', 'O', 'G', '\0' };
+const char IndexMagic[8] = { 'G', 'P', 'S', 'D', 'I', 'D', 'X', '\0' };
+const uint16_t Version = 2;
+const uint32_t Alignment = 8;
+const int64_t IndexInterval = 1000000000;
+
+struct FileHeader
+{
+    char magic[8];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t reserved;
+};
+
+enum EntryType
+{
+    LineEntry = 1,
+    SourceEntry = 2
+};
+
+struct EntryHeader
+{
+    int64_t receivedAt;
+    uint32_t size;
+    uint16_t tag;
+    uint16_t type;
+};
+
+struct IndexEntry
+{
+    int64_t receivedAt;
+    uint64_t offset;            // of the line's EntryHeader
+};
+
+struct Footer
+{
+    uint64_t indexOffset;
+    uint64_t indexCount;
+    char magic[8];
+};
+
+inline uint32_t paddedSize(uint32_t size)
+{
+    return (size + Alignment - 1) & ~(Alignment - 1);
+}
+
+}
+
+#endif // GPSDLOGFORMAT_H
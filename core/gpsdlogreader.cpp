@@ -0,0 +1,302 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdlogreader.h"
+
+#include "gpsdjson.h"
+#include "gpsdnmea.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+const int64_t MsecsPerDay = 86400000;
+
+bool isEarlier(const GpsdLog::IndexEntry& point, int64_t receivedAt)
+{
+    return point.receivedAt < receivedAt;
+}
+
+}
+
+GpsdLogReader::GpsdLogReader()
+    : _data(0)
+    , _size(0)
+    , _offset(0)
+    , _format(NmeaFormat)
+    , _index(0)
+    , _indexCount(0)
+    , _firstTime(-1)
+    , _time(0)
+    , _lastTimeOfDay(-1)
+{
+}
+
+GpsdLogReader::~GpsdLogReader()
+{
+    close();
+}
+
+bool GpsdLogReader::open(const std::string& path)
+{
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return false;
+    struct stat st;
+    if(fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    _size = size_t(st.st_size);
+    if(_size > 0)
+    {
+        void* data = mmap(0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED)
+        {
+            ::close(fd);
+            _size = 0;
+            return false;
+        }
+        _data = static_cast<const char*>(data);
+        madvise(data, _size, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+
+    GpsdLog::FileHeader header;
+    if(_size >= sizeof(header) && memcmp(_data, GpsdLog::Magic, sizeof(header.magic)) == 0)
+    {
+        memcpy(&header, _data, sizeof(header));
+        if(header.version < 1 || header.version > GpsdLog::Version
+           || header.headerSize < sizeof(header))
+        {
+            close();
+            return false;
+        }
+        _format = BinaryFormat;
+        readIndex();
+    }
+    else
+    {
+        size_t i = 0;
+        while(i < _size && (_data[i] == ' ' || _data[i] == '\r' || _data[i] == '\n'))
+            ++i;
+        _format = i < _size && _data[i] == '{' ? JsonFormat : NmeaFormat;
+    }
+    rewind();
+    return true;
+}
+
+void GpsdLogReader::close()
+{
+    if(_data)
+        munmap(const_cast<char*>(_data), _size);
+    _data = 0;
+    _size = 0;
+    _offset = 0;
+    _index = 0;
+    _indexCount = 0;
+    _sources.clear();
+}
+
+bool GpsdLogReader::isOpen() const
+{
+    return _data != 0;
+}
+
+GpsdLogReader::Format GpsdLogReader::format() const
+{
+    return _format;
+}
+
+bool GpsdLogReader::next(Entry* entry)
+{
+    return _format == BinaryFormat ? nextBinary(entry) : nextText(entry);
+}
+
+void GpsdLogReader::rewind()
+{
+    _offset = 0;
+    if(_format == BinaryFormat && _data)
+    {
+        GpsdLog::FileHeader header;
+        memcpy(&header, _data, sizeof(header));
+        _offset = header.headerSize;
+    }
+    _firstTime = -1;
+    _time = 0;
+    _lastTimeOfDay = -1;
+}
+
+int64_t GpsdLogReader::startTime()
+{
+    if(_format != BinaryFormat)
+        return 0;
+    if(_indexCount > 0)
+        return _index[0].receivedAt;
+
+    size_t offset = _offset;
+    Entry entry;
+    rewind();
+    int64_t time = next(&entry) ? entry.receivedAt : 0;
+    _offset = offset;
+    return time;
+}
+
+bool GpsdLogReader::seek(int64_t receivedAt)
+{
+    rewind();
+    if(_indexCount > 0)
+    {
+        // the last index point before the time, the lines up to the next
+        // one span at most IndexInterval
+        const GpsdLog::IndexEntry* end = _index + _indexCount;
+        const GpsdLog::IndexEntry* point = std::lower_bound(_index, end, receivedAt, isEarlier);
+        if(point != _index)
+            _offset = size_t((point - 1)->offset);
+    }
+
+    Entry entry;
+    size_t offset = _offset;
+    while(next(&entry))
+    {
+        if(entry.receivedAt >= receivedAt)
+        {
+            _offset = offset;
+            return true;
+        }
+        offset = _offset;
+    }
+    return false;
+}
+
+bool GpsdLogReader::hasIndex() const
+{
+    return _indexCount > 0;
+}
+
+std::string GpsdLogReader::sourceName(uint16_t tag) const
+{
+    std::map<uint16_t,std::string>::const_iterator it = _sources.find(tag);
+    return it != _sources.end() ? it->second : std::string();
+}
+
+bool GpsdLogReader::nextBinary(Entry* entry)
+{
+    GpsdLog::EntryHeader header;
+    while(_offset + sizeof(header) <= _size)
+    {
+        memcpy(&header, _data + _offset, sizeof(header));
+        size_t payload = _offset + sizeof(header);
+        // a zeroed header ends a log whose writer did not close it
+        if(header.type == 0 || payload + header.size > _size)
+            break;
+        _offset = payload + GpsdLog::paddedSize(header.size);
+
+        if(header.type == GpsdLog::SourceEntry)
+        {
+            _sources[header.tag] = std::string(_data + payload, header.size);
+        }
+        else if(header.type == GpsdLog::LineEntry)
+        {
+            entry->receivedAt = header.receivedAt;
+            entry->tag = header.tag;
+            entry->data = _data + payload;
+            entry->size = int(header.size);
+            return true;
+        }
+    }
+    _offset = _size;
+    return false;
+}
+
+void GpsdLogReader::readIndex()
+{
+    GpsdLog::Footer footer;
+    if(_size < sizeof(GpsdLog::FileHeader) + sizeof(footer))
+        return;
+    memcpy(&footer, _data + _size - sizeof(footer), sizeof(footer));
+    if(memcmp(footer.magic, GpsdLog::IndexMagic, sizeof(footer.magic)) != 0)
+        return;
+    size_t indexSize = _size - sizeof(footer) - footer.indexOffset;
+    if(footer.indexOffset > _size - sizeof(footer) || footer.indexOffset % GpsdLog::Alignment != 0
+       || indexSize != footer.indexCount * sizeof(GpsdLog::IndexEntry))
+        return;
+    _index = reinterpret_cast<const GpsdLog::IndexEntry*>(_data + footer.indexOffset);
+    _indexCount = size_t(footer.indexCount);
+}
+
+bool GpsdLogReader::nextText(Entry* entry)
+{
+    if(_offset >= _size)
+        return false;
+    const char* start = _data + _offset;
+    const char* eol = static_cast<const char*>(memchr(start, '\n', _size - _offset));
+    int size = eol ? int(eol - start) + 1 : int(_size - _offset);
+    _offset += size;
+
+    updateTextTime(start, size);
+    entry->receivedAt = (_firstTime < 0 ? 0 : _time - _firstTime) * 1000000;
+    entry->tag = 0;
+    entry->data = start;
+    entry->size = size;
+    return true;
+}
+
+void GpsdLogReader::updateTextTime(const char* data, int size)
+{
+    GpsdFix fix;
+    if(_format == JsonFormat)
+    {
+        if(!GpsdJson::isClass(data, size, "TPV") || !GpsdJson::decodeTPV(data, size, &fix))
+            return;
+    }
+    else if(!GpsdNmea::decodePosition(data, size, &fix))
+    {
+        return;
+    }
+    if(!fix.hasTime())
+        return;
+
+    // only the time of day is used, it is in every timed sentence; a
+    // jump back by more than half a day is taken as midnight
+    int64_t day = _time / MsecsPerDay;
+    if(_lastTimeOfDay >= 0 && fix.timeOfDay < _lastTimeOfDay - MsecsPerDay / 2)
+        ++day;
+    int64_t time = day * MsecsPerDay + fix.timeOfDay;
+    // sentences of one epoch may carry the time of the previous one
+    if(time > _time || _firstTime < 0)
+        _time = time;
+    _lastTimeOfDay = fix.timeOfDay;
+    if(_firstTime < 0)
+        _firstTime = _time;
+}
@@ -0,0 +1,106 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDLOGREADER_H
+#define GPSDLOGREADER_H
+
+#include "gpsdlogformat.h"
+
+#include <map>
+#include <stdint.h>
+#include <string>
+
+// Reads the lines of a recorded gpsd stream: a binary log written by
+// GpsdRecorder, or a text file of NMEA sentences or gpsd JSON reports,
+// one per line. The file is memory mapped and the lines point into the
+// mapping, so they are valid until the reader is closed. Binary logs with
+// a time index are seeked in O(log n), all others by reading up to the
+// wanted time.
+class GpsdLogReader
+{
+public:
+    enum Format
+    {
+        BinaryFormat,
+        NmeaFormat,
+        JsonFormat
+    };
+
+    struct Entry
+    {
+        // ns; in binary logs the CLOCK_MONOTONIC time of the recording, in
+        // text files the time since the first fix time of the file
+        int64_t receivedAt;
+        uint16_t tag;           // connection of a binary log, 0 for text
+        const char* data;       // the line, including its line feed
+        int size;
+    };
+
+    GpsdLogReader();
+    ~GpsdLogReader();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+    Format format() const;
+
+    // Next line of the log, false at its end.
+    bool next(Entry* entry);
+    void rewind();
+
+    // Time of the first line, in the time base of Entry::receivedAt.
+    int64_t startTime();
+    // Moves to the first line received at or after the given time.
+    bool seek(int64_t receivedAt);
+    bool hasIndex() const;
+
+    // Connection a tag was recorded from, known once its source entry was
+    // read; after a seek, that may not be the case.
+    std::string sourceName(uint16_t tag) const;
+
+private:
+    GpsdLogReader(const GpsdLogReader&);
+    GpsdLogReader& operator=(const GpsdLogReader&);
+
+    bool nextBinary(Entry* entry);
+    bool nextText(Entry* entry);
+    void updateTextTime(const char* data, int size);
+    void readIndex();
+
+    const char* _data;
+    size_t _size;
+    size_t _offset;
+    Format _format;
+    const GpsdLog::IndexEntry* _index;
+    size_t _indexCount;
+    std::map<uint16_t,std::string> _sources;
+
+    // text files are timed by the fix times in them, in ms
+    int64_t _firstTime;
+    int64_t _time;
+    int _lastTimeOfDay;
+};
+
+#endif // GPSDLOGREADER_H
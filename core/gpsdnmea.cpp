@@ -0,0 +1,594 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdnmea.h"
+
+#include <cmath>
+
+namespace
+{
+
+const int MaxFields = 24;
+
+int hexDigit(char c)
+{
+    if(c >= '0' && c <= '9')
+        return c - '0';
+    if(c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if(c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+double powerOfTen(int exponent)
+{
+    static const double Exact[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    if(exponent < int(sizeof(Exact)/sizeof(Exact[0])))
+        return Exact[exponent];
+    return std::pow(10.0, exponent);
+}
+
+bool digitAt(const GpsdNmea::Field& field, int index, int* digit)
+{
+    if(index >= field.size || field.data[index] < '0' || field.data[index] > '9')
+        return false;
+    *digit = field.data[index] - '0';
+    return true;
+}
+
+bool twoDigits(const GpsdNmea::Field& field, int index, int* value)
+{
+    int high = 0, low = 0;
+    if(!digitAt(field, index, &high) || !digitAt(field, index + 1, &low))
+        return false;
+    *value = high * 10 + low;
+    return true;
+}
+
+// hhmmss[.sss] to ms since midnight
+bool readTime(const GpsdNmea::Field& field, int* timeOfDay)
+{
+    int hours = 0, minutes = 0, seconds = 0;
+    if(!twoDigits(field, 0, &hours) || !twoDigits(field, 2, &minutes)
+            || !twoDigits(field, 4, &seconds))
+        return false;
+    if(hours > 23 || minutes > 59 || seconds > 59)
+        return false;
+    int msecs = 0;
+    if(field.size > 6)
+    {
+        double fraction = 0;
+        GpsdNmea::Field rest = { field.data + 6, field.size - 6 };
+        if(field.data[6] != '.' || !GpsdNmea::toDouble(rest, &fraction))
+            return false;
+        msecs = int(fraction * 1000 + 0.5);
+        if(msecs > 999)
+            msecs = 999;
+    }
+    *timeOfDay = ((hours * 60 + minutes) * 60 + seconds) * 1000 + msecs;
+    return true;
+}
+
+// ddmmyy, years from 1970 to 2069
+bool readDate(const GpsdNmea::Field& field, GpsdFix* fix)
+{
+    int day = 0, month = 0, year = 0;
+    if(field.size != 6 || !twoDigits(field, 0, &day) || !twoDigits(field, 2, &month)
+            || !twoDigits(field, 4, &year))
+        return false;
+    if(day < 1 || day > 31 || month < 1 || month > 12)
+        return false;
+    fix->year = year < 70 ? 2000 + year : 1900 + year;
+    fix->month = month;
+    fix->day = day;
+    return true;
+}
+
+// dddmm.mmmm with its hemisphere
+bool readCoordinate(const GpsdNmea::Field& value, const GpsdNmea::Field& hemisphere,
+                    char negative, char positive, double* degrees)
+{
+    double raw = 0;
+    if(hemisphere.size != 1 || !GpsdNmea::toDouble(value, &raw) || raw < 0)
+        return false;
+    if(hemisphere.data[0] != negative && hemisphere.data[0] != positive)
+        return false;
+    double whole = std::floor(raw / 100);
+    double result = whole + (raw - whole * 100) / 60;
+    *degrees = hemisphere.data[0] == negative ? -result : result;
+    return true;
+}
+
+void readPosition(const GpsdNmea::Field* fields, int index, GpsdFix* fix)
+{
+    double latitude = 0, longitude = 0;
+    if(readCoordinate(fields[index], fields[index + 1], 'S', 'N', &latitude)
+            && readCoordinate(fields[index + 2], fields[index + 3], 'W', 'E', &longitude)
+            && latitude >= -90 && latitude <= 90 && longitude >= -180 && longitude <= 180)
+    {
+        fix->latitude = latitude;
+        fix->longitude = longitude;
+    }
+}
+
+bool isChar(const GpsdNmea::Field& field, char c)
+{
+    return field.size == 1 && field.data[0] == c;
+}
+
+bool decodeRMC(const GpsdNmea::Field* fields, int count, GpsdFix* fix)
+{
+    /*
+    $GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6A
+
+    Where:
+      RMC          Recommended minimum data
+      123519       UTC time of the fix
+      A            Status, A = active, V = void
+      4807.038,N   Latitude
+      01131.000,E  Longitude
+      022.4        Speed over ground, knots
+      084.4        Track angle, degrees true
+      230394       Date
+      003.1,W      Magnetic variation
+  */
+    if(count < 10)
+        return false;
+    readTime(fields[1], &fix->timeOfDay);
+    fix->hasFix = isChar(fields[2], 'A');
+    readPosition(fields, 3, fix);
+    double knots = 0;
+    if(GpsdNmea::toDouble(fields[7], &knots))
+        fix->speed = knots * 1852.0 / 3600.0;
+    GpsdNmea::toDouble(fields[8], &fix->course);
+    readDate(fields[9], fix);
+    double variation = 0;
+    if(count > 11 && GpsdNmea::toDouble(fields[10], &variation))
+        fix->magneticVariation = isChar(fields[11], 'W') ? -variation : variation;
+    return true;
+}
+
+bool decodeGGA(const GpsdNmea::Field* fields, int count, GpsdFix* fix)
+{
+    /*
+    $GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47
+
+    Where:
+      GGA          Global positioning system fix data
+      123519       UTC time of the fix
+      4807.038,N   Latitude
+      01131.000,E  Longitude
+      1            Fix quality, 0 = invalid
+      08           Number of satellites being tracked
+      0.9          Horizontal dilution of position
+      545.4,M      Altitude above mean sea level, meters
+  */
+    if(count < 10)
+        return false;
+    readTime(fields[1], &fix->timeOfDay);
+    readPosition(fields, 2, fix);
+    int quality = 0;
+    fix->hasFix = GpsdNmea::toInt(fields[6], &quality) && quality > 0;
+    if(fix->hasPosition())
+        GpsdNmea::toDouble(fields[9], &fix->altitude);
+    return true;
+}
+
+bool decodeGLL(const GpsdNmea::Field* fields, int count, GpsdFix* fix)
+{
+    /*
+    $GPGLL,4916.45,N,12311.12,W,225444,A,*1D
+
+    Where:
+      GLL          Geographic position, latitude and longitude
+      4916.45,N    Latitude
+      12311.12,W   Longitude
+      225444       UTC time of the fix
+      A            Status, A = active, V = void
+  */
+    if(count < 7)
+        return false;
+    readPosition(fields, 1, fix);
+    readTime(fields[5], &fix->timeOfDay);
+    fix->hasFix = isChar(fields[6], 'A');
+    return true;
+}
+
+bool decodeVTG(const GpsdNmea::Field* fields, int count, GpsdFix* fix)
+{
+    /*
+    $GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48
+
+    Where:
+      VTG          Track made good and ground speed
+      054.7,T      True track made good, degrees
+      034.4,M      Magnetic track made good, degrees
+      005.5,N      Ground speed, knots
+      010.2,K      Ground speed, km/h
+  */
+    if(count < 9)
+        return false;
+    GpsdNmea::toDouble(fields[1], &fix->course);
+    double kmh = 0;
+    if(GpsdNmea::toDouble(fields[7], &kmh))
+        fix->speed = kmh / 3.6;
+    return true;
+}
+
+bool decodeGST(const GpsdNmea::Field* fields, int count, GpsdFix* fix)
+{
+    /*
+    $GPGST,172814.0,0.006,0.023,0.020,273.6,0.023,0.020,0.031*6A
+
+    Where:
+      GST      Pseudorange error statistics
+      172814.0 UTC time of the associated position fix
+      0.006    RMS of the pseudorange residuals
+      0.023    Semi-major axis of the error ellipse, meters
+      0.020    Semi-minor axis of the error ellipse, meters
+      273.6    Orientation of the semi-major axis, degrees
+      0.023    Standard deviation of latitude error, meters
+      0.020    Standard deviation of longitude error, meters
+      0.031    Standard deviation of altitude error, meters
+  */
+    if(count < 9 || !readTime(fields[1], &fix->timeOfDay))
+        return false;
+    double latErr = 0, lonErr = 0;
+    if(GpsdNmea::toDouble(fields[6], &latErr) && GpsdNmea::toDouble(fields[7], &lonErr))
+        fix->horizontalAccuracy = std::sqrt(latErr * latErr + lonErr * lonErr);
+    GpsdNmea::toDouble(fields[8], &fix->verticalAccuracy);
+    return true;
+}
+
+}
+
+namespace GpsdNmea
+{
+
+bool hasValidChecksum(const char *data, int size)
+{
+    int asteriskIndex = -1;
+    for (int i = 0; i < size; ++i)
+    {
+        if (data[i] == '*')
+        {
+            asteriskIndex = i;
+            break;
+        }
+    }
+
+    const int CSUM_LEN = 2;
+    if (asteriskIndex < 0 || asteriskIndex + CSUM_LEN >= size)
+        return false;
+
+    // XOR byte value of all characters between '$' and '*'
+    int result = 0;
+    for (int i = 1; i < asteriskIndex; ++i)
+        result ^= data[i];
+
+    int high = hexDigit(data[asteriskIndex + 1]);
+    int low = hexDigit(data[asteriskIndex + 2]);
+    return high >= 0 && low >= 0 && high * 16 + low == (result & 0xff);
+}
+
+GpsdSatellite::System talkerSystem(const char* data, int size)
+{
+    if(size < 3 || data[0] != '$')
+        return GpsdSatellite::UnknownSystem;
+    if(data[1] == 'B' && data[2] == 'D')
+        return GpsdSatellite::Beidou;
+    if(data[1] != 'G')
+        return GpsdSatellite::UnknownSystem;
+    switch(data[2])
+    {
+    case 'P': return GpsdSatellite::Gps;
+    case 'L': return GpsdSatellite::Glonass;
+    case 'A': return GpsdSatellite::Galileo;
+    case 'B': return GpsdSatellite::Beidou;
+    case 'Q': return GpsdSatellite::Qzss;
+    case 'I': return GpsdSatellite::Navic;
+    default: return GpsdSatellite::UnknownSystem;
+    }
+}
+
+GpsdSatellite::System prnSystem(int prn)
+{
+    if(prn >= 1 && prn <= 32)
+        return GpsdSatellite::Gps;
+    if((prn >= 33 && prn <= 64) || (prn >= 120 && prn <= 158))
+        return GpsdSatellite::Sbas;
+    if(prn >= 65 && prn <= 96)
+        return GpsdSatellite::Glonass;
+    if(prn >= 193 && prn <= 200)
+        return GpsdSatellite::Qzss;
+    if((prn >= 201 && prn <= 263) || (prn >= 401 && prn <= 437))
+        return GpsdSatellite::Beidou;
+    if(prn >= 301 && prn <= 336)
+        return GpsdSatellite::Galileo;
+    return GpsdSatellite::UnknownSystem;
+}
+
+bool isSentence(const char* data, int size, const char* type)
+{
+    return size >= 6 && data[0] == '$'
+            && data[3] == type[0] && data[4] == type[1] && data[5] == type[2];
+}
+
+int splitFields(const char* data, int size, Field* fields, int maxFields)
+{
+    int count = 0;
+    int start = 0;
+    for(int i = 0; i <= size && count < maxFields; ++i)
+    {
+        if(i == size || data[i] == ',' || data[i] == '*' || data[i] == '\r' || data[i] == '\n')
+        {
+            fields[count].data = data + start;
+            fields[count].size = i - start;
+            ++count;
+            if(i == size || data[i] != ',')
+                break;
+            start = i + 1;
+        }
+    }
+    return count;
+}
+
+bool toDouble(const Field& field, double* value)
+{
+    const char* p = field.data;
+    const char* end = field.data + field.size;
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    // up to 18 significant digits are kept, the rest only scales
+    int64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    for(; p < end && *p >= '0' && *p <= '9'; ++p)
+    {
+        any = true;
+        if(digits < 18)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        }
+        else
+            ++exponent;
+    }
+    if(p < end && *p == '.')
+    {
+        for(++p; p < end && *p >= '0' && *p <= '9'; ++p)
+        {
+            any = true;
+            if(digits < 18)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                --exponent;
+            }
+        }
+    }
+    if(!any)
+        return false;
+    if(p < end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negativeExponent = false;
+        if(p < end && (*p == '-' || *p == '+'))
+            negativeExponent = *p++ == '-';
+        if(p == end)
+            return false;
+        int explicitExponent = 0;
+        for(; p < end && *p >= '0' && *p <= '9'; ++p)
+        {
+            if(explicitExponent < 1000)
+                explicitExponent = explicitExponent * 10 + (*p - '0');
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+    if(p != end)
+        return false;
+
+    double result = double(mantissa);
+    if(exponent < 0)
+        result /= powerOfTen(-exponent);
+    else if(exponent > 0)
+        result *= powerOfTen(exponent);
+    *value = negative ? -result : result;
+    return true;
+}
+
+bool toInt(const Field& field, int* value)
+{
+    const char* p = field.data;
+    const char* end = field.data + field.size;
+    bool negative = false;
+    if(p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    if(p == end || end - p > 9)
+        return false;
+    int result = 0;
+    for(; p < end; ++p)
+    {
+        if(*p < '0' || *p > '9')
+            return false;
+        result = result * 10 + (*p - '0');
+    }
+    *value = negative ? -result : result;
+    return true;
+}
+
+bool decodePosition(const char* data, int size, GpsdFix* fix)
+{
+    if(size < 6 || data[0] != '$' || !hasValidChecksum(data, size))
+        return false;
+
+    Field fields[MaxFields];
+    int count = splitFields(data, size, fields, MaxFields);
+    if(fields[0].size != 6)
+        return false;
+
+    fix->clear();
+    if(isSentence(data, size, "RMC"))
+        return decodeRMC(fields, count, fix);
+    if(isSentence(data, size, "GGA"))
+        return decodeGGA(fields, count, fix);
+    if(isSentence(data, size, "GLL"))
+        return decodeGLL(fields, count, fix);
+    if(isSentence(data, size, "VTG"))
+        return decodeVTG(fields, count, fix);
+    if(isSentence(data, size, "GST"))
+        return decodeGST(fields, count, fix);
+    return false;
+}
+
+bool decodeGSV(const char* data, int size, Gsv* gsv)
+{
+    /*
+    $GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75
+    Where:
+
+      GSV          Satellites in view
+      2            Number of sentences for full data
+      1            sentence 1 of 2
+      08           Number of satellites in view
+
+      01           Satellite PRN number
+      40           Elevation, degrees
+      083          Azimuth, degrees
+      46           SNR - higher is better
+         for up to 4 satellites per sentence
+      1            NMEA 4.11: signal ID, e.g. 1 for GPS L1 C/A
+      *75          the checksum data, always begins with *
+  */
+    if(!isSentence(data, size, "GSV") || !hasValidChecksum(data, size))
+        return false;
+
+    Field fields[MaxFields];
+    int count = splitFields(data, size, fields, MaxFields);
+    if(count < 4 || !toInt(fields[1], &gsv->sentenceCount)
+            || !toInt(fields[2], &gsv->sentenceIndex)
+            || gsv->sentenceIndex < 1 || gsv->sentenceIndex > gsv->sentenceCount)
+        return false;
+    if(!toInt(fields[3], &gsv->satellitesInView))
+        gsv->satellitesInView = -1;
+    gsv->system = talkerSystem(data, size);
+    if((count - 4) % 4 != 1 || !toInt(fields[count - 1], &gsv->signalId))
+        gsv->signalId = 0;
+
+    // complete groups of four fields only, NMEA 4.11 appends a signal ID
+    gsv->satelliteCount = 0;
+    for(int pos = 4; pos + 4 <= count && gsv->satelliteCount < 4; pos += 4)
+    {
+        GpsdSatellite& satellite = gsv->satellites[gsv->satelliteCount];
+        if(!toInt(fields[pos], &satellite.prn))
+            continue;
+        if(!toInt(fields[pos + 1], &satellite.elevation))
+            satellite.elevation = -1;
+        if(!toInt(fields[pos + 2], &satellite.azimuth))
+            satellite.azimuth = -1;
+        if(!toInt(fields[pos + 3], &satellite.snr))
+            satellite.snr = -1;
+        satellite.used = false;
+        // GPS talkers report SBAS and QZSS satellites as well
+        satellite.system = gsv->system;
+        if(satellite.system == GpsdSatellite::Gps || satellite.system == GpsdSatellite::UnknownSystem)
+            satellite.system = prnSystem(satellite.prn);
+        ++gsv->satelliteCount;
+    }
+    return true;
+}
+
+bool decodeGSA(const char* data, int size, Gsa* gsa)
+{
+    /*
+    $GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39
+
+    Where:
+      GSA      Satellite status
+      A        Auto selection of 2D or 3D fix (M = manual)
+      3        3D fix - values include: 1 = no fix
+                                        2 = 2D fix
+                                        3 = 3D fix
+      04,05... PRNs of satellites used for fix (space for 12)
+      2.5      PDOP (dilution of precision)
+      1.3      Horizontal dilution of precision (HDOP)
+      2.1      Vertical dilution of precision (VDOP)
+      1        NMEA 4.11: system ID, 1 GPS, 2 GLONASS, 3 Galileo, 4 BeiDou,
+               5 QZSS, 6 NavIC
+      *39      the checksum data, always begins with *
+  */
+    if(!isSentence(data, size, "GSA") || !hasValidChecksum(data, size))
+        return false;
+
+    Field fields[MaxFields];
+    int count = splitFields(data, size, fields, MaxFields);
+    if(count < 15)
+        return false;
+
+    int fixType = 0;
+    if(toInt(fields[2], &fixType) && fixType >= GpsdSky::NoFix && fixType <= GpsdSky::Fix3D)
+        gsa->fixMode = GpsdSky::FixMode(fixType);
+    else
+        gsa->fixMode = GpsdSky::UnknownFix;
+
+    static const GpsdSatellite::System SystemIds[] = {
+        GpsdSatellite::UnknownSystem, GpsdSatellite::Gps, GpsdSatellite::Glonass,
+        GpsdSatellite::Galileo, GpsdSatellite::Beidou, GpsdSatellite::Qzss, GpsdSatellite::Navic
+    };
+    GpsdSatellite::System system = talkerSystem(data, size);
+    if(count > 18 && toInt(fields[18], &gsa->systemId) && gsa->systemId > 0 && gsa->systemId <= 6)
+        system = SystemIds[gsa->systemId];
+    else
+        gsa->systemId = 0;
+
+    gsa->prnCount = 0;
+    for(int i = 3; i < 15; ++i)
+    {
+        int& prn = gsa->prns[gsa->prnCount];
+        if(!toInt(fields[i], &prn))
+            continue;
+        GpsdSatellite::System& prnSystem = gsa->systems[gsa->prnCount];
+        prnSystem = system;
+        if(system == GpsdSatellite::Gps || system == GpsdSatellite::UnknownSystem)
+            prnSystem = GpsdNmea::prnSystem(prn);
+        ++gsa->prnCount;
+    }
+    gsa->system = gsa->prnCount > 0 ? gsa->systems[0] : system;
+
+    const double NaN = std::nan("");
+    gsa->pdop = count > 15 && toDouble(fields[15], &gsa->pdop) ? gsa->pdop : NaN;
+    gsa->hdop = count > 16 && toDouble(fields[16], &gsa->hdop) ? gsa->hdop : NaN;
+    gsa->vdop = count > 17 && toDouble(fields[17], &gsa->vdop) ? gsa->vdop : NaN;
+    return true;
+}
+
+}
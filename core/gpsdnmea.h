@@ -0,0 +1,99 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDNMEA_H
+#define GPSDNMEA_H
+
+#include "gpsdfix.h"
+
+namespace GpsdNmea
+{
+
+// from qlocationutils.cpp
+bool hasValidChecksum(const char* data, int size);
+
+// true for sentences like "$GPGSV,..." or "$GNGSV,..." if type is "GSV"
+bool isSentence(const char* data, int size, const char* type);
+
+// Comma separated field of a sentence, pointing into the sentence.
+struct Field
+{
+    const char* data;
+    int size;
+};
+
+// Splits a sentence up to its checksum into at most maxFields fields, the
+// first one being the address ("$GPRMC"). Returns the number of fields.
+int splitFields(const char* data, int size, Field* fields, int maxFields);
+
+// Locale independent number parsing; false for empty or malformed fields.
+bool toDouble(const Field& field, double* value);
+bool toInt(const Field& field, int* value);
+
+// Satellite system of the talker of a sentence ("$GL..." is GLONASS),
+// unknown for "$GN..." and other talkers.
+GpsdSatellite::System talkerSystem(const char* data, int size);
+
+// Satellite system of an NMEA satellite ID, as far as its range tells.
+GpsdSatellite::System prnSystem(int prn);
+
+// Decodes an RMC, GGA, GLL, VTG or GST sentence with a valid checksum into
+// fix, leaving the values the sentence does not carry unknown.
+bool decodePosition(const char* data, int size, GpsdFix* fix);
+
+// Decoded GSV sentence, one part of a sky view cycle. With NMEA 4.11, a
+// receiver sends a cycle per system and signal.
+struct Gsv
+{
+    GpsdSatellite::System system;   // of the talker
+    int signalId;                   // NMEA 4.11, 0 if not given
+    int sentenceCount;
+    int sentenceIndex;
+    int satellitesInView;
+    int satelliteCount;
+    GpsdSatellite satellites[4];
+};
+
+// Decoded GSA sentence. Multi-constellation receivers send one per system
+// and epoch, carrying the system ID from NMEA 4.11 on.
+struct Gsa
+{
+    GpsdSatellite::System system;       // of the first satellite if mixed
+    int systemId;                       // NMEA 4.11 system ID, 0 if not given
+    GpsdSky::FixMode fixMode;
+    int prnCount;
+    int prns[GpsdSky::MaxSatellites];   // up to 12 from a GSA sentence
+    GpsdSatellite::System systems[GpsdSky::MaxSatellites];
+    double pdop;
+    double hdop;
+    double vdop;
+};
+
+bool decodeGSV(const char* data, int size, Gsv* gsv);
+bool decodeGSA(const char* data, int size, Gsa* gsa);
+
+}
+
+#endif // GPSDNMEA_H
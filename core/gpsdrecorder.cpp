@@ -0,0 +1,192 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdrecorder.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+GpsdRecorder::GpsdRecorder()
+    : _fd(-1)
+    , _window(0)
+    , _windowStart(0)
+    , _windowSize(0)
+    , _end(0)
+{
+}
+
+GpsdRecorder::~GpsdRecorder()
+{
+    close();
+}
+
+bool GpsdRecorder::open(const std::string& path)
+{
+    close();
+    std::lock_guard<std::mutex> locker(_mutex);
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(_fd < 0)
+        return false;
+
+    GpsdLog::FileHeader header = GpsdLog::FileHeader();
+    memcpy(header.magic, GpsdLog::Magic, sizeof(header.magic));
+    header.version = GpsdLog::Version;
+    header.headerSize = sizeof(header);
+    if(!mapWindow(sizeof(header)))
+    {
+        ::close(_fd);
+        _fd = -1;
+        return false;
+    }
+    memcpy(_window, &header, sizeof(header));
+    _end = sizeof(header);
+    return true;
+}
+
+void GpsdRecorder::close()
+{
+    std::lock_guard<std::mutex> locker(_mutex);
+    if(_fd < 0)
+        return;
+    unmapWindow();
+    // drop the unused rest of the last window
+    while(ftruncate(_fd, _end) != 0 && errno == EINTR)
+        ;
+    writeIndex();
+    ::close(_fd);
+    _fd = -1;
+    _end = 0;
+    _tags.clear();
+    _index.clear();
+}
+
+bool GpsdRecorder::isOpen() const
+{
+    return _fd >= 0;
+}
+
+uint16_t GpsdRecorder::sourceTag(const std::string& name)
+{
+    std::lock_guard<std::mutex> locker(_mutex);
+    std::map<std::string,uint16_t>::const_iterator it = _tags.find(name);
+    if(it != _tags.end())
+        return it->second;
+    uint16_t tag = uint16_t(_tags.size() + 1);
+    _tags[name] = tag;
+    append(GpsdLog::SourceEntry, tag, 0, name.data(), uint32_t(name.size()));
+    return tag;
+}
+
+void GpsdRecorder::record(uint16_t tag, int64_t receivedAt, const char* data, int size)
+{
+    std::lock_guard<std::mutex> locker(_mutex);
+    size_t offset = _end;
+    if(!append(GpsdLog::LineEntry, tag, receivedAt, data, uint32_t(size)))
+        return;
+    if(_index.empty() || receivedAt >= _index.back().receivedAt + GpsdLog::IndexInterval)
+    {
+        GpsdLog::IndexEntry point;
+        point.receivedAt = receivedAt;
+        point.offset = offset;
+        _index.push_back(point);
+    }
+}
+
+bool GpsdRecorder::append(uint16_t type, uint16_t tag, int64_t receivedAt,
+                          const char* data, uint32_t size)
+{
+    size_t entrySize = sizeof(GpsdLog::EntryHeader) + GpsdLog::paddedSize(size);
+    if(_fd < 0 || entrySize > WindowSize / 2 || !mapWindow(entrySize))
+        return false;
+
+    // the window is zero filled, so the padding needs no writing
+    char* entry = _window + (_end - _windowStart);
+    GpsdLog::EntryHeader header;
+    header.receivedAt = receivedAt;
+    header.size = size;
+    header.tag = tag;
+    header.type = type;
+    memcpy(entry, &header, sizeof(header));
+    memcpy(entry + sizeof(header), data, size);
+    _end += entrySize;
+    return true;
+}
+
+bool GpsdRecorder::mapWindow(size_t size)
+{
+    if(_window && _end + size <= _windowStart + _windowSize)
+        return true;
+
+    // the new window starts at the page holding the end of the log
+    unmapWindow();
+    size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    size_t start = _end / pageSize * pageSize;
+    if(ftruncate(_fd, start + WindowSize) != 0)
+        return false;
+    void* window = mmap(0, WindowSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, start);
+    if(window == MAP_FAILED)
+        return false;
+    _window = static_cast<char*>(window);
+    _windowStart = start;
+    _windowSize = WindowSize;
+    return true;
+}
+
+void GpsdRecorder::writeIndex()
+{
+    GpsdLog::EntryHeader terminator = GpsdLog::EntryHeader();
+    GpsdLog::Footer footer;
+    footer.indexOffset = _end + sizeof(terminator);
+    footer.indexCount = _index.size();
+    memcpy(footer.magic, GpsdLog::IndexMagic, sizeof(footer.magic));
+
+    struct iovec parts[3];
+    parts[0].iov_base = &terminator;
+    parts[0].iov_len = sizeof(terminator);
+    parts[1].iov_base = _index.data();
+    parts[1].iov_len = _index.size() * sizeof(GpsdLog::IndexEntry);
+    parts[2].iov_base = &footer;
+    parts[2].iov_len = sizeof(footer);
+    size_t size = parts[0].iov_len + parts[1].iov_len + parts[2].iov_len;
+    // without its footer, the log is still readable, just not seekable
+    if(pwritev(_fd, parts, 3, off_t(_end)) != ssize_t(size))
+    {
+        while(ftruncate(_fd, _end) != 0 && errno == EINTR)
+            ;
+    }
+}
+
+void GpsdRecorder::unmapWindow()
+{
+    if(!_window)
+        return;
+    munmap(_window, _windowSize);
+    _window = 0;
+    _windowSize = 0;
+}
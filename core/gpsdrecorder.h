@@ -0,0 +1,77 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDRECORDER_H
+#define GPSDRECORDER_H
+
+#include "gpsdlogformat.h"
+
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Appends received lines to a binary log, see gpsdlogformat.h. The file
+// is written through a memory mapped window, so recording a line costs a
+// copy into the mapping; the kernel writes it back in the background.
+class GpsdRecorder
+{
+public:
+    GpsdRecorder();
+    ~GpsdRecorder();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    // Tag for the lines of a connection, recorded on first use.
+    uint16_t sourceTag(const std::string& name);
+
+    void record(uint16_t tag, int64_t receivedAt, const char* data, int size);
+
+private:
+    GpsdRecorder(const GpsdRecorder&);
+    GpsdRecorder& operator=(const GpsdRecorder&);
+
+    // the mapping grows by whole windows
+    static const size_t WindowSize = 4 << 20;
+
+    bool append(uint16_t type, uint16_t tag, int64_t receivedAt, const char* data, uint32_t size);
+    bool mapWindow(size_t size);
+    void unmapWindow();
+    void writeIndex();
+
+    std::mutex _mutex;
+    int _fd;
+    char* _window;
+    size_t _windowStart;
+    size_t _windowSize;
+    size_t _end;
+    std::map<std::string,uint16_t> _tags;
+    std::vector<GpsdLog::IndexEntry> _index;
+};
+
+#endif // GPSDRECORDER_H
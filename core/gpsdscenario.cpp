@@ -0,0 +1,645 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdscenario.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+const double Pi = 3.14159265358979323846;
+const double MetersPerDegree = 111320.0;
+const double BaseAltitude = 520.0;      // m
+const double GeoidSeparation = 47.0;    // m
+const double ManoeuvreInterval = 5.0;   // s between changes of turn rate and speed
+const double MaxSpeed = 30.0;           // m/s
+const double MaxTurnRate = 6.0;         // degrees per second
+const double Acceleration = 2.0;        // m/s^2
+const double Uere = 3.0;                // m, range error behind the accuracies
+const int MinElevation = 10;            // degrees for a satellite to be used
+const int MaxUsedPerSystem = 12;        // fits one GSA sentence
+
+struct Constellation
+{
+    GpsdSatellite::System system;
+    const char* talker;
+    int systemId;           // NMEA 4.11
+    int gnssId;             // gpsd, as in u-blox UBX
+    int firstId;            // NMEA satellite ID
+    int count;
+    int prnOffset;          // gpsd PRN minus NMEA satellite ID
+    int svidOffset;         // NMEA satellite ID minus svid
+};
+
+const int ConstellationCount = 5;
+const Constellation Constellations[ConstellationCount] = {
+    { GpsdSatellite::Gps,     "GP", 1, 0, 1,  32, 0,   0 },
+    { GpsdSatellite::Glonass, "GL", 2, 6, 65, 24, 0,   64 },
+    { GpsdSatellite::Galileo, "GA", 3, 2, 1,  30, 300, 0 },
+    { GpsdSatellite::Beidou,  "GB", 4, 3, 1,  37, 400, 0 },
+    { GpsdSatellite::Qzss,    "GQ", 5, 5, 1,  7,  192, 0 }
+};
+
+// std::uniform_real_distribution and std::shuffle differ between standard
+// libraries, the raw output of std::mt19937 does not
+double uniform(std::mt19937& random, double low, double high)
+{
+    return low + (high - low) * (random() / 4294967296.0);
+}
+
+// date of days since 1970-01-01, the inverse of daysFromCivil() in gpsdfix.cpp
+void civilFromDays(int64_t days, int* year, int* month, int* day)
+{
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    *day = int(doy - (153 * mp + 2) / 5 + 1);
+    *month = int(mp < 10 ? mp + 3 : mp - 9);
+    *year = int(yoe + era * 400 + (*month <= 2));
+}
+
+// numbers are written without printf, whose decimal point depends on the
+// locale
+void appendInt(std::string* out, int64_t value, int width = 1)
+{
+    char digits[20];
+    int count = 0;
+    uint64_t magnitude = value < 0 ? uint64_t(-value) : uint64_t(value);
+    do
+    {
+        digits[count++] = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while(magnitude > 0);
+    if(value < 0)
+        out->push_back('-');
+    for(int i = count; i < width; ++i)
+        out->push_back('0');
+    while(count > 0)
+        out->push_back(digits[--count]);
+}
+
+void appendFixed(std::string* out, double value, int decimals)
+{
+    int64_t scale = 1;
+    for(int i = 0; i < decimals; ++i)
+        scale *= 10;
+    int64_t scaled = std::llround(std::fabs(value) * scale);
+    if(value < 0 && scaled != 0)
+        out->push_back('-');
+    appendInt(out, scaled / scale);
+    if(decimals > 0)
+    {
+        out->push_back('.');
+        appendInt(out, scaled % scale, decimals);
+    }
+}
+
+// ddmm.mmmm,N
+void appendCoordinate(std::string* out, double degrees, int degreeDigits,
+                      char positive, char negative)
+{
+    int64_t units = std::llround(std::fabs(degrees) * 600000.0);
+    appendInt(out, units / 600000, degreeDigits);
+    appendInt(out, units % 600000 / 10000, 2);
+    out->push_back('.');
+    appendInt(out, units % 10000, 4);
+    out->push_back(',');
+    out->push_back(degrees < 0 ? negative : positive);
+}
+
+// the four fields of latitude and longitude, empty without a fix
+void appendPosition(std::string* out, const GpsdFix& fix)
+{
+    if(!fix.hasFix)
+    {
+        out->append(",,,");
+        return;
+    }
+    appendCoordinate(out, fix.latitude, 2, 'N', 'S');
+    out->push_back(',');
+    appendCoordinate(out, fix.longitude, 3, 'E', 'W');
+}
+
+// hhmmss.sss
+void appendNmeaTime(std::string* out, const GpsdFix& fix)
+{
+    appendInt(out, fix.timeOfDay / 3600000, 2);
+    appendInt(out, fix.timeOfDay / 60000 % 60, 2);
+    appendInt(out, fix.timeOfDay / 1000 % 60, 2);
+    out->push_back('.');
+    appendInt(out, fix.timeOfDay % 1000, 3);
+}
+
+// "yyyy-mm-ddThh:mm:ss.sssZ", quoted
+void appendIsoTime(std::string* out, const GpsdFix& fix)
+{
+    out->push_back('"');
+    appendInt(out, fix.year, 4);
+    out->push_back('-');
+    appendInt(out, fix.month, 2);
+    out->push_back('-');
+    appendInt(out, fix.day, 2);
+    out->push_back('T');
+    appendInt(out, fix.timeOfDay / 3600000, 2);
+    out->push_back(':');
+    appendInt(out, fix.timeOfDay / 60000 % 60, 2);
+    out->push_back(':');
+    appendInt(out, fix.timeOfDay / 1000 % 60, 2);
+    out->push_back('.');
+    appendInt(out, fix.timeOfDay % 1000, 3);
+    out->append("Z\"");
+}
+
+// a sentence is written in place, its checksum once it is complete
+size_t beginSentence(std::string* out, const char* talker, const char* type)
+{
+    size_t start = out->size();
+    out->push_back('$');
+    out->append(talker);
+    out->append(type);
+    return start;
+}
+
+void endSentence(std::string* out, size_t start)
+{
+    static const char Hex[] = "0123456789ABCDEF";
+    unsigned char checksum = 0;
+    for(size_t i = start + 1; i < out->size(); ++i)
+        checksum ^= (unsigned char)(*out)[i];
+    out->push_back('*');
+    out->push_back(Hex[checksum >> 4]);
+    out->push_back(Hex[checksum & 0xf]);
+    out->append("\r\n");
+}
+
+}
+
+GpsdScenario::Options::Options()
+    : seed(1)
+    , rate(1.0)
+    , satellites(12)
+    , constellations(ConstellationCount)
+    , startTime(INT64_C(1577836800000))     // 2020-01-01T00:00:00Z
+    , latitude(48.1173)
+    , longitude(11.5167)
+{
+}
+
+GpsdScenario::GpsdScenario(const Options& options)
+    : _options(options)
+    , _random(options.seed)
+    , _epoch(-1)
+    , _heading(0.0)
+    , _turnRate(0.0)
+    , _targetSpeed(0.0)
+    , _distance(0.0)
+{
+    if(!(_options.rate > 0.0))
+        _options.rate = 1.0;
+    if(_options.constellations < 1)
+        _options.constellations = 1;
+    if(_options.constellations > ConstellationCount)
+        _options.constellations = ConstellationCount;
+    if(_options.satellites < 0)
+        _options.satellites = 0;
+    if(_options.satellites > maxSatellites(_options.constellations))
+        _options.satellites = maxSatellites(_options.constellations);
+
+    // the satellites are dealt to the constellations in turn
+    for(int c = 0; c < ConstellationCount; ++c)
+        _systemCounts[c] = 0;
+    for(int dealt = 0; dealt < _options.satellites; )
+    {
+        for(int c = 0; c < _options.constellations && dealt < _options.satellites; ++c)
+        {
+            if(_systemCounts[c] < Constellations[c].count)
+            {
+                ++_systemCounts[c];
+                ++dealt;
+            }
+        }
+    }
+
+    // each constellation has a random selection of its satellites in view
+    _sky.clear();
+    for(int c = 0; c < _options.constellations; ++c)
+    {
+        const Constellation& constellation = Constellations[c];
+        std::vector<int> ids(constellation.count);
+        for(int i = 0; i < constellation.count; ++i)
+            ids[i] = constellation.firstId + i;
+        for(int i = 0; i < _systemCounts[c]; ++i)
+            std::swap(ids[i], ids[i + _random() % (constellation.count - i)]);
+        std::sort(ids.begin(), ids.begin() + _systemCounts[c]);
+
+        for(int i = 0; i < _systemCounts[c]; ++i)
+        {
+            GpsdSatellite& satellite = _sky.satellites[_sky.satelliteCount++];
+            satellite.prn = ids[i];
+            satellite.system = constellation.system;
+            satellite.elevation = -1;
+            satellite.azimuth = -1;
+            satellite.snr = -1;
+            satellite.used = false;
+
+            Orbit orbit;
+            orbit.phase = uniform(_random, 0.0, 2.0 * Pi);
+            orbit.period = uniform(_random, 4.0, 12.0) * 3600.0;
+            orbit.azimuth = uniform(_random, 0.0, 360.0);
+            orbit.azimuthRate = 360.0 / (uniform(_random, 6.0, 24.0) * 3600.0)
+                    * (_random() & 1 ? 1.0 : -1.0);
+            orbit.snr = int(uniform(_random, 40.0, 50.0));
+            _orbits.push_back(orbit);
+        }
+    }
+
+    _heading = uniform(_random, 0.0, 360.0);
+    _fix.latitude = _options.latitude;
+    _fix.longitude = _options.longitude;
+    _fix.altitude = BaseAltitude;
+    _fix.speed = 0.0;
+    _fix.course = _heading;
+    _fix.climb = 0.0;
+}
+
+int GpsdScenario::maxSatellites(int constellations)
+{
+    int count = 0;
+    for(int c = 0; c < constellations && c < ConstellationCount; ++c)
+        count += Constellations[c].count;
+    return count < GpsdSky::MaxSatellites ? count : int(GpsdSky::MaxSatellites);
+}
+
+void GpsdScenario::next()
+{
+    ++_epoch;
+
+    // a new manoeuvre every few seconds: a turn rate and a speed to reach
+    int64_t manoeuvreEpochs = std::llround(ManoeuvreInterval * _options.rate);
+    if(manoeuvreEpochs < 1 || _epoch % manoeuvreEpochs == 0)
+    {
+        _turnRate = uniform(_random, -MaxTurnRate, MaxTurnRate);
+        _targetSpeed = uniform(_random, 0.0, MaxSpeed);
+    }
+    if(_epoch > 0)
+        move(1.0 / _options.rate);
+
+    int64_t msecs = time();
+    int64_t days = (msecs >= 0 ? msecs : msecs - 86399999) / 86400000;
+    civilFromDays(days, &_fix.year, &_fix.month, &_fix.day);
+    _fix.timeOfDay = int(msecs - days * 86400000);
+
+    updateSky(_epoch / _options.rate);
+}
+
+int64_t GpsdScenario::epoch() const
+{
+    return _epoch;
+}
+
+int64_t GpsdScenario::elapsed() const
+{
+    return _epoch > 0 ? std::llround(_epoch * 1e9 / _options.rate) : 0;
+}
+
+int64_t GpsdScenario::time() const
+{
+    return _options.startTime + (elapsed() + 500000) / 1000000;
+}
+
+const GpsdFix& GpsdScenario::fix() const
+{
+    return _fix;
+}
+
+const GpsdSky& GpsdScenario::sky() const
+{
+    return _sky;
+}
+
+void GpsdScenario::move(double seconds)
+{
+    double speed = _fix.speed;
+    double step = Acceleration * seconds;
+    if(_targetSpeed > speed + step)
+        speed += step;
+    else if(_targetSpeed < speed - step)
+        speed -= step;
+    else
+        speed = _targetSpeed;
+
+    _heading = std::fmod(_heading + _turnRate * seconds + 360.0, 360.0);
+    double distance = speed * seconds;
+    double heading = _heading * Pi / 180.0;
+    _fix.latitude += distance * std::cos(heading) / MetersPerDegree;
+    _fix.longitude += distance * std::sin(heading)
+            / (MetersPerDegree * std::cos(_fix.latitude * Pi / 180.0));
+    _distance += distance;
+
+    // rolling hills
+    double altitude = BaseAltitude + 15.0 * std::sin(_distance / 500.0);
+    _fix.climb = (altitude - _fix.altitude) / seconds;
+    _fix.altitude = altitude;
+    _fix.speed = speed;
+    _fix.course = _heading;
+}
+
+void GpsdScenario::updateSky(double seconds)
+{
+    int used = 0;
+    int begin = 0;
+    for(int c = 0; c < _options.constellations; ++c)
+    {
+        int end = begin + _systemCounts[c];
+        for(int i = begin; i < end; ++i)
+        {
+            const Orbit& orbit = _orbits[i];
+            GpsdSatellite& satellite = _sky.satellites[i];
+            double rise = 0.5 + 0.5 * std::sin(orbit.phase + 2.0 * Pi * seconds / orbit.period);
+            satellite.elevation = 5 + int(80.0 * rise + 0.5);
+            double azimuth = std::fmod(orbit.azimuth + orbit.azimuthRate * seconds, 360.0);
+            satellite.azimuth = int(azimuth < 0.0 ? azimuth + 360.0 : azimuth) % 360;
+            // weaker towards the horizon, and a little noisy
+            satellite.snr = orbit.snr - (90 - satellite.elevation) / 4
+                    + int(std::floor(uniform(_random, -2.0, 3.0)));
+            satellite.used = false;
+        }
+
+        // the highest satellites of the constellation are used
+        for(int n = 0; n < MaxUsedPerSystem; ++n)
+        {
+            int highest = -1;
+            for(int i = begin; i < end; ++i)
+            {
+                const GpsdSatellite& satellite = _sky.satellites[i];
+                if(!satellite.used && satellite.elevation >= MinElevation
+                   && (highest < 0 || satellite.elevation > _sky.satellites[highest].elevation))
+                    highest = i;
+            }
+            if(highest < 0)
+                break;
+            _sky.satellites[highest].used = true;
+            ++used;
+        }
+        begin = end;
+    }
+
+    _fix.hasFix = used >= 4;
+    if(_fix.hasFix)
+    {
+        _sky.fixMode = GpsdSky::Fix3D;
+        _sky.hdop = 0.5 + 6.0 / used;
+        _sky.vdop = 1.5 * _sky.hdop;
+        _sky.pdop = std::sqrt(_sky.hdop * _sky.hdop + _sky.vdop * _sky.vdop);
+        _fix.horizontalAccuracy = Uere * _sky.hdop;
+        _fix.verticalAccuracy = Uere * _sky.vdop;
+    }
+    else
+    {
+        _sky.fixMode = GpsdSky::NoFix;
+        _sky.hdop = 99.99;
+        _sky.vdop = 99.99;
+        _sky.pdop = 99.99;
+        _fix.horizontalAccuracy = std::numeric_limits<double>::quiet_NaN();
+        _fix.verticalAccuracy = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+void GpsdScenario::appendNmea(std::string* out) const
+{
+    // sentences of all constellations have the "GN" talker
+    const char* talker = Constellations[0].talker;
+    int active = 0;
+    for(int c = 0; c < _options.constellations; ++c)
+    {
+        if(_systemCounts[c] > 0 && active++ == 0)
+            talker = Constellations[c].talker;
+    }
+    if(active > 1)
+        talker = "GN";
+
+    int used = 0;
+    for(int i = 0; i < _sky.satelliteCount; ++i)
+        used += _sky.satellites[i].used;
+
+    size_t start = beginSentence(out, talker, "RMC,");
+    appendNmeaTime(out, _fix);
+    out->append(_fix.hasFix ? ",A," : ",V,");
+    appendPosition(out, _fix);
+    out->push_back(',');
+    appendFixed(out, _fix.speed * 3600.0 / 1852.0, 2);
+    out->push_back(',');
+    appendFixed(out, _fix.course, 1);
+    out->push_back(',');
+    appendInt(out, _fix.day, 2);
+    appendInt(out, _fix.month, 2);
+    appendInt(out, _fix.year % 100, 2);
+    out->append(_fix.hasFix ? ",,,A" : ",,,N");
+    endSentence(out, start);
+
+    start = beginSentence(out, talker, "GGA,");
+    appendNmeaTime(out, _fix);
+    out->push_back(',');
+    appendPosition(out, _fix);
+    out->append(_fix.hasFix ? ",1," : ",0,");
+    appendInt(out, used, 2);
+    out->push_back(',');
+    appendFixed(out, _sky.hdop, 1);
+    out->push_back(',');
+    if(_fix.hasFix)
+        appendFixed(out, _fix.altitude, 1);
+    out->append(",M,");
+    appendFixed(out, GeoidSeparation, 1);
+    out->append(",M,,");
+    endSentence(out, start);
+
+    int begin = 0;
+    for(int c = 0; c < _options.constellations; ++c)
+    {
+        const Constellation& constellation = Constellations[c];
+        int end = begin + _systemCounts[c];
+        if(end > begin)
+        {
+            start = beginSentence(out, talker, "GSA,A,");
+            out->push_back(_fix.hasFix ? '3' : '1');
+            int listed = 0;
+            for(int i = begin; i < end; ++i)
+            {
+                if(_sky.satellites[i].used)
+                {
+                    out->push_back(',');
+                    appendInt(out, _sky.satellites[i].prn, 2);
+                    ++listed;
+                }
+            }
+            for(; listed < MaxUsedPerSystem; ++listed)
+                out->push_back(',');
+            out->push_back(',');
+            appendFixed(out, _sky.pdop, 2);
+            out->push_back(',');
+            appendFixed(out, _sky.hdop, 2);
+            out->push_back(',');
+            appendFixed(out, _sky.vdop, 2);
+            out->push_back(',');
+            appendInt(out, constellation.systemId);
+            endSentence(out, start);
+        }
+        begin = end;
+    }
+
+    // four satellites per GSV sentence, all on signal 1
+    begin = 0;
+    for(int c = 0; c < _options.constellations; ++c)
+    {
+        const Constellation& constellation = Constellations[c];
+        int count = _systemCounts[c];
+        int sentences = (count + 3) / 4;
+        for(int s = 0; s < sentences; ++s)
+        {
+            start = beginSentence(out, constellation.talker, "GSV,");
+            appendInt(out, sentences);
+            out->push_back(',');
+            appendInt(out, s + 1);
+            out->push_back(',');
+            appendInt(out, count, 2);
+            for(int i = begin + s * 4; i < begin + count && i < begin + s * 4 + 4; ++i)
+            {
+                const GpsdSatellite& satellite = _sky.satellites[i];
+                out->push_back(',');
+                appendInt(out, satellite.prn, 2);
+                out->push_back(',');
+                appendInt(out, satellite.elevation, 2);
+                out->push_back(',');
+                appendInt(out, satellite.azimuth, 3);
+                out->push_back(',');
+                appendInt(out, satellite.snr, 2);
+            }
+            out->append(",1");
+            endSentence(out, start);
+        }
+        begin += count;
+    }
+
+    // errors of latitude and longitude are equal, the ellipse is a circle
+    start = beginSentence(out, talker, "GST,");
+    appendNmeaTime(out, _fix);
+    if(_fix.hasFix)
+    {
+        double error = _fix.horizontalAccuracy / std::sqrt(2.0);
+        out->push_back(',');
+        appendFixed(out, Uere, 1);
+        out->push_back(',');
+        appendFixed(out, error, 1);
+        out->push_back(',');
+        appendFixed(out, error, 1);
+        out->append(",0.0,");
+        appendFixed(out, error, 1);
+        out->push_back(',');
+        appendFixed(out, error, 1);
+        out->push_back(',');
+        appendFixed(out, _fix.verticalAccuracy, 1);
+    }
+    else
+        out->append(",,,,,,,");
+    endSentence(out, start);
+}
+
+void GpsdScenario::appendTpv(std::string* out, const char* device) const
+{
+    out->append("{\"class\":\"TPV\",\"device\":\"");
+    out->append(device);
+    out->append(_fix.hasFix ? "\",\"mode\":3,\"time\":" : "\",\"mode\":1,\"time\":");
+    appendIsoTime(out, _fix);
+    if(_fix.hasFix)
+    {
+        double error = _fix.horizontalAccuracy / std::sqrt(2.0);
+        out->append(",\"lat\":");
+        appendFixed(out, _fix.latitude, 9);
+        out->append(",\"lon\":");
+        appendFixed(out, _fix.longitude, 9);
+        out->append(",\"alt\":");
+        appendFixed(out, _fix.altitude, 3);
+        out->append(",\"track\":");
+        appendFixed(out, _fix.course, 1);
+        out->append(",\"speed\":");
+        appendFixed(out, _fix.speed, 3);
+        out->append(",\"climb\":");
+        appendFixed(out, _fix.climb, 3);
+        out->append(",\"epx\":");
+        appendFixed(out, error, 3);
+        out->append(",\"epy\":");
+        appendFixed(out, error, 3);
+        out->append(",\"epv\":");
+        appendFixed(out, _fix.verticalAccuracy, 3);
+    }
+    out->push_back('}');
+}
+
+void GpsdScenario::appendSky(std::string* out, const char* device) const
+{
+    out->append("{\"class\":\"SKY\",\"device\":\"");
+    out->append(device);
+    out->append("\",\"time\":");
+    appendIsoTime(out, _fix);
+    out->append(",\"hdop\":");
+    appendFixed(out, _sky.hdop, 2);
+    out->append(",\"vdop\":");
+    appendFixed(out, _sky.vdop, 2);
+    out->append(",\"pdop\":");
+    appendFixed(out, _sky.pdop, 2);
+    out->append(",\"satellites\":[");
+
+    int begin = 0;
+    for(int c = 0; c < _options.constellations; ++c)
+    {
+        const Constellation& constellation = Constellations[c];
+        int end = begin + _systemCounts[c];
+        for(int i = begin; i < end; ++i)
+        {
+            const GpsdSatellite& satellite = _sky.satellites[i];
+            out->append(i > 0 ? ",{\"PRN\":" : "{\"PRN\":");
+            appendInt(out, satellite.prn + constellation.prnOffset);
+            out->append(",\"gnssid\":");
+            appendInt(out, constellation.gnssId);
+            out->append(",\"svid\":");
+            appendInt(out, satellite.prn - constellation.svidOffset);
+            out->append(",\"el\":");
+            appendInt(out, satellite.elevation);
+            out->append(",\"az\":");
+            appendInt(out, satellite.azimuth);
+            out->append(",\"ss\":");
+            appendInt(out, satellite.snr);
+            out->append(satellite.used ? ",\"used\":true}" : ",\"used\":false}");
+        }
+        begin = end;
+    }
+    out->append("]}");
+}
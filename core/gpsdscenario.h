@@ -0,0 +1,110 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDSCENARIO_H
+#define GPSDSCENARIO_H
+
+#include "gpsdfix.h"
+
+#include <random>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Synthetic receiver for stress tests: a vehicle on a random trajectory
+// under a sky of up to five constellations, written as NMEA 0183 and as
+// gpsd JSON describing the same epochs. Equal options give equal epochs.
+class GpsdScenario
+{
+public:
+    struct Options
+    {
+        Options();
+
+        uint32_t seed;
+        double rate;            // epochs per second
+        int satellites;         // in view, see maxSatellites()
+        int constellations;     // GPS, GLONASS, Galileo, BeiDou and QZSS, in this order
+        int64_t startTime;      // UTC ms since 1970-01-01 of the first epoch
+        double latitude;        // start position in degrees
+        double longitude;
+    };
+
+    explicit GpsdScenario(const Options& options);
+
+    // Satellites the first constellations can have in view at once.
+    static int maxSatellites(int constellations);
+
+    // Advances to the next epoch; the first call yields the first one.
+    void next();
+
+    int64_t epoch() const;      // from 0
+    int64_t elapsed() const;    // ns since the first epoch
+    int64_t time() const;       // UTC ms since 1970-01-01
+    const GpsdFix& fix() const;
+
+    // Satellites sorted by system and NMEA satellite ID; GLONASS from 65,
+    // the others of a system from 1.
+    const GpsdSky& sky() const;
+
+    // Appends the epoch as sentences ending in "\r\n": RMC, GGA, a GSA per
+    // constellation with its NMEA 4.11 system ID, a GSV cycle per
+    // constellation and GST. The talker is "GN" for shared sentences if
+    // there is more than one constellation.
+    void appendNmea(std::string* out) const;
+
+    // Append gpsd's TPV and SKY reports of the epoch, without line ending.
+    // In SKY, the PRNs are numbered as by gpsd, with gnssid and svid.
+    void appendTpv(std::string* out, const char* device) const;
+    void appendSky(std::string* out, const char* device) const;
+
+private:
+    struct Orbit
+    {
+        double phase;           // rad
+        double period;          // s of a rise and set
+        double azimuth;         // degrees at the first epoch
+        double azimuthRate;     // degrees per second
+        int snr;                // dB-Hz at the zenith
+    };
+
+    void move(double seconds);
+    void updateSky(double seconds);
+
+    Options _options;
+    std::mt19937 _random;
+    int64_t _epoch;
+    GpsdFix _fix;
+    GpsdSky _sky;
+    std::vector<Orbit> _orbits;
+    int _systemCounts[5];
+
+    double _heading;            // degrees from true north
+    double _turnRate;           // degrees per second
+    double _targetSpeed;        // m/s
+    double _distance;           // m since the first epoch
+};
+
+#endif // GPSDSCENARIO_H
@@ -0,0 +1,337 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdskyassembler.h"
+
+#include <cmath>
+
+namespace
+{
+
+void clearUse(GpsdNmea::Gsa* use)
+{
+    use->system = GpsdSatellite::UnknownSystem;
+    use->systemId = 0;
+    use->fixMode = GpsdSky::UnknownFix;
+    use->prnCount = 0;
+    use->pdop = std::nan("");
+    use->hdop = std::nan("");
+    use->vdop = std::nan("");
+}
+
+// all keys of the last epoch are in
+bool isComplete(const std::bitset<128>& pending, const std::bitset<128>& last)
+{
+    return last.any() && (pending & last) == last;
+}
+
+bool isOrderedBefore(const GpsdSatellite& a, const GpsdSatellite& b)
+{
+    return a.system < b.system || (a.system == b.system && a.prn < b.prn);
+}
+
+}
+
+GpsdSkyAssembler::GpsdSkyAssembler()
+    : _pendingViewReceivedAt(0)
+    , _viewStarted(false)
+    , _viewReceivedAt(0)
+    , _pendingUseReceivedAt(0)
+    , _pendingUsePositions(0)
+    , _useStarted(false)
+    , _useReceivedAt(0)
+    , _skyReceivedAt(0)
+    , _done(0)
+    , _rejected(false)
+    , _lastWasUse(false)
+{
+    reset();
+}
+
+unsigned int GpsdSkyAssembler::addSentence(const char* data, int size, int64_t receivedAt)
+{
+    unsigned int completed = 0;
+    _rejected = false;
+    GpsdNmea::Gsv gsv;
+    GpsdNmea::Gsa gsa;
+    if(GpsdNmea::decodeGSV(data, size, &gsv))
+    {
+        size_t key = size_t(gsv.system) * 16 + (gsv.signalId & 15);
+        if(gsv.sentenceIndex == 1 && _pendingViewKeys.test(key))
+            completed |= completeView();
+        if(!_viewStarted)
+        {
+            _viewStarted = true;
+            _pendingViewReceivedAt = receivedAt;
+        }
+        for(int i = 0; i < gsv.satelliteCount; ++i)
+            addToPendingView(gsv.satellites[i]);
+
+        // last sentence of the cycle
+        if(gsv.sentenceIndex == gsv.sentenceCount)
+        {
+            _pendingViewKeys.set(key);
+            if(isComplete(_pendingViewKeys, _viewKeys))
+                completed |= completeView();
+        }
+    }
+    else if(GpsdNmea::decodeGSA(data, size, &gsa))
+    {
+        size_t key = size_t(gsa.system);
+        if(gsa.systemId == 0
+                && GpsdNmea::talkerSystem(data, size) == GpsdSatellite::UnknownSystem)
+        {
+            // GNGSA before NMEA 4.11 names no system, and none at all while
+            // a system is not used; these sentences are keyed by their
+            // position in the epoch. They are sent as a block, so a new
+            // block or a system repeating starts the next epoch.
+            if(_useStarted && (!_lastWasUse || (gsa.prnCount > 0
+                                                && _pendingUseSystems.test(gsa.system))))
+                completed |= completeUse();
+            key = PositionKeys + (_pendingUsePositions < MaxPositions ? _pendingUsePositions
+                                                                      : MaxPositions - 1);
+            ++_pendingUsePositions;
+            if(gsa.prnCount > 0)
+                _pendingUseSystems.set(gsa.system);
+        }
+        else if(_pendingUseKeys.test(key))
+            completed |= completeUse();
+        if(!_useStarted)
+        {
+            _useStarted = true;
+            _pendingUseReceivedAt = receivedAt;
+        }
+        addToPendingUse(gsa);
+        _pendingUseKeys.set(key);
+        if(isComplete(_pendingUseKeys, _useKeys))
+            completed |= completeUse();
+    }
+    else if(GpsdNmea::isSentence(data, size, "GSV") || GpsdNmea::isSentence(data, size, "GSA"))
+        _rejected = GpsdNmea::hasValidChecksum(data, size);
+    _lastWasUse = GpsdNmea::isSentence(data, size, "GSA");
+    return completed | completeSky();
+}
+
+bool GpsdSkyAssembler::rejected() const
+{
+    return _rejected;
+}
+
+unsigned int GpsdSkyAssembler::addSky(const GpsdSky& sky, int64_t receivedAt)
+{
+    _pendingView.clear();
+    _pendingViewKeys.reset();
+    _viewStarted = false;
+    clearUse(&_pendingUse);
+    _pendingUseKeys.reset();
+    _pendingUseSystems.reset();
+    _pendingUsePositions = 0;
+    _useStarted = false;
+
+    for(int i = 0; i < sky.satelliteCount; ++i)
+        addToPendingView(sky.satellites[i]);
+    _view = _pendingView;
+    _pendingView.clear();
+    _viewReceivedAt = receivedAt;
+
+    clearUse(&_use);
+    for(int i = 0; i < sky.satelliteCount; ++i)
+    {
+        if(!sky.satellites[i].used)
+            continue;
+        _use.prns[_use.prnCount] = sky.satellites[i].prn;
+        _use.systems[_use.prnCount] = sky.satellites[i].system;
+        ++_use.prnCount;
+    }
+    _use.fixMode = sky.fixMode;
+    _use.pdop = sky.pdop;
+    _use.hdop = sky.hdop;
+    _use.vdop = sky.vdop;
+    _useReceivedAt = receivedAt;
+    _done = ViewCompleted | UseCompleted;
+    return ViewCompleted | UseCompleted | completeSky();
+}
+
+unsigned int GpsdSkyAssembler::flush()
+{
+    unsigned int completed = completeView() | completeUse();
+    return completed | completeSky();
+}
+
+void GpsdSkyAssembler::reset()
+{
+    _pendingView.clear();
+    _pendingViewKeys.reset();
+    _viewStarted = false;
+    _view.clear();
+    _viewKeys.reset();
+    clearUse(&_pendingUse);
+    _pendingUseKeys.reset();
+    _pendingUseSystems.reset();
+    _pendingUsePositions = 0;
+    _useStarted = false;
+    clearUse(&_use);
+    _useKeys.reset();
+    _lastWasUse = false;
+    _sky.clear();
+    _done = 0;
+}
+
+const GpsdSky& GpsdSkyAssembler::view() const
+{
+    return _view;
+}
+
+const GpsdNmea::Gsa& GpsdSkyAssembler::use() const
+{
+    return _use;
+}
+
+const GpsdSky& GpsdSkyAssembler::sky() const
+{
+    return _sky;
+}
+
+int64_t GpsdSkyAssembler::viewReceivedAt() const
+{
+    return _viewReceivedAt;
+}
+
+int64_t GpsdSkyAssembler::useReceivedAt() const
+{
+    return _useReceivedAt;
+}
+
+int64_t GpsdSkyAssembler::skyReceivedAt() const
+{
+    return _skyReceivedAt;
+}
+
+unsigned int GpsdSkyAssembler::completeView()
+{
+    if(!_viewStarted)
+        return 0;
+    _view = _pendingView;
+    _viewReceivedAt = _pendingViewReceivedAt;
+    // systems or signals that disappeared are not waited for again
+    _viewKeys = _pendingViewKeys;
+    _pendingView.clear();
+    _pendingViewKeys.reset();
+    _viewStarted = false;
+    _done |= ViewCompleted;
+    return ViewCompleted;
+}
+
+unsigned int GpsdSkyAssembler::completeUse()
+{
+    if(!_useStarted)
+        return 0;
+    _use = _pendingUse;
+    _useReceivedAt = _pendingUseReceivedAt;
+    _useKeys = _pendingUseKeys;
+    clearUse(&_pendingUse);
+    _pendingUseKeys.reset();
+    _pendingUseSystems.reset();
+    _pendingUsePositions = 0;
+    _useStarted = false;
+    _done |= UseCompleted;
+    return UseCompleted;
+}
+
+unsigned int GpsdSkyAssembler::completeSky()
+{
+    // the satellites in use are resolved against the view of the same epoch
+    if(_done != (ViewCompleted | UseCompleted))
+        return 0;
+    _done = 0;
+
+    _sky = _view;
+    for(int i = 0; i < _sky.satelliteCount; ++i)
+    {
+        GpsdSatellite& satellite = _sky.satellites[i];
+        satellite.used = false;
+        for(int j = 0; j < _use.prnCount && !satellite.used; ++j)
+            satellite.used = _use.prns[j] == satellite.prn && _use.systems[j] == satellite.system;
+    }
+    _sky.fixMode = _use.fixMode;
+    _sky.pdop = _use.pdop;
+    _sky.hdop = _use.hdop;
+    _sky.vdop = _use.vdop;
+    _skyReceivedAt = _viewReceivedAt < _useReceivedAt ? _viewReceivedAt : _useReceivedAt;
+    return SkyCompleted;
+}
+
+void GpsdSkyAssembler::addToPendingView(const GpsdSatellite& satellite)
+{
+    int pos = 0;
+    while(pos < _pendingView.satelliteCount && isOrderedBefore(_pendingView.satellites[pos], satellite))
+        ++pos;
+
+    // a satellite seen on several signals is kept once, with its strongest
+    if(pos < _pendingView.satelliteCount && !isOrderedBefore(satellite, _pendingView.satellites[pos]))
+    {
+        GpsdSatellite& known = _pendingView.satellites[pos];
+        if(known.elevation < 0)
+            known.elevation = satellite.elevation;
+        if(known.azimuth < 0)
+            known.azimuth = satellite.azimuth;
+        if(satellite.snr > known.snr)
+            known.snr = satellite.snr;
+        return;
+    }
+    if(_pendingView.satelliteCount == GpsdSky::MaxSatellites)
+        return;
+    for(int i = _pendingView.satelliteCount; i > pos; --i)
+        _pendingView.satellites[i] = _pendingView.satellites[i - 1];
+    _pendingView.satellites[pos] = satellite;
+    ++_pendingView.satelliteCount;
+}
+
+void GpsdSkyAssembler::addToPendingUse(const GpsdNmea::Gsa& gsa)
+{
+    if(_pendingUse.prnCount == 0)
+        _pendingUse.system = gsa.system;
+    // the receiver's fix is the best of the per system fixes
+    if(gsa.fixMode > _pendingUse.fixMode)
+        _pendingUse.fixMode = gsa.fixMode;
+    if(!std::isnan(gsa.pdop))
+        _pendingUse.pdop = gsa.pdop;
+    if(!std::isnan(gsa.hdop))
+        _pendingUse.hdop = gsa.hdop;
+    if(!std::isnan(gsa.vdop))
+        _pendingUse.vdop = gsa.vdop;
+
+    for(int i = 0; i < gsa.prnCount && _pendingUse.prnCount < GpsdSky::MaxSatellites; ++i)
+    {
+        bool known = false;
+        for(int j = 0; j < _pendingUse.prnCount && !known; ++j)
+            known = _pendingUse.prns[j] == gsa.prns[i] && _pendingUse.systems[j] == gsa.systems[i];
+        if(known)
+            continue;
+        _pendingUse.prns[_pendingUse.prnCount] = gsa.prns[i];
+        _pendingUse.systems[_pendingUse.prnCount] = gsa.systems[i];
+        ++_pendingUse.prnCount;
+    }
+}
@@ -0,0 +1,120 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDSKYASSEMBLER_H
+#define GPSDSKYASSEMBLER_H
+
+#include "gpsdnmea.h"
+
+#include <bitset>
+
+// Collects the GSV cycles and GSA sentences of a receiver epoch into a
+// GpsdSky. Multi-constellation receivers send a GSV cycle per system and
+// signal and a GSA sentence per system in each epoch; GNGSA sentences
+// without an NMEA 4.11 system ID are told apart by their position. The
+// cycles and sentences of the last epoch tell when the next one is
+// complete; one of them repeating ends an epoch as well. Satellites are
+// ordered by system and PRN.
+class GpsdSkyAssembler
+{
+public:
+    enum Completion
+    {
+        ViewCompleted = 0x1,    // the GSV cycles of an epoch, see view()
+        UseCompleted = 0x2,     // the GSA sentences of an epoch, see use()
+        SkyCompleted = 0x4      // both of them, see sky()
+    };
+
+    GpsdSkyAssembler();
+
+    // Decodes a GSV or GSA sentence received at receivedAt. Returns the
+    // Completion flags of what it completed.
+    unsigned int addSentence(const char* data, int size, int64_t receivedAt);
+
+    // true if the last sentence added was a GSV or GSA sentence with a
+    // valid checksum that could not be decoded
+    bool rejected() const;
+
+    // Takes over a sky view that is complete already, e.g. a gpsd SKY
+    // report. Returns all Completion flags.
+    unsigned int addSky(const GpsdSky& sky, int64_t receivedAt);
+
+    // Completes what has been collected of the current epoch, e.g. after
+    // the last sentences of a recording.
+    unsigned int flush();
+
+    void reset();
+
+    const GpsdSky& view() const;
+    const GpsdNmea::Gsa& use() const;
+    const GpsdSky& sky() const;
+
+    // receive time of the first GSV sentence of the last view, of the
+    // first GSA sentence of the last use and of the older of both for
+    // the sky
+    int64_t viewReceivedAt() const;
+    int64_t useReceivedAt() const;
+    int64_t skyReceivedAt() const;
+
+private:
+    // a GSV cycle per system and signal, a GSA sentence per system or
+    // position
+    typedef std::bitset<128> KeySetT;
+    static const int PositionKeys = 64;
+    static const int MaxPositions = 64;
+
+    unsigned int completeView();
+    unsigned int completeUse();
+    unsigned int completeSky();
+    void addToPendingView(const GpsdSatellite& satellite);
+    void addToPendingUse(const GpsdNmea::Gsa& gsa);
+
+    GpsdSky _pendingView;
+    int64_t _pendingViewReceivedAt;
+    KeySetT _pendingViewKeys;
+    bool _viewStarted;
+    GpsdSky _view;
+    int64_t _viewReceivedAt;
+    KeySetT _viewKeys;
+
+    GpsdNmea::Gsa _pendingUse;
+    int64_t _pendingUseReceivedAt;
+    KeySetT _pendingUseKeys;
+    // systems of the pending GSA sentences keyed by position
+    KeySetT _pendingUseSystems;
+    int _pendingUsePositions;
+    bool _useStarted;
+    GpsdNmea::Gsa _use;
+    int64_t _useReceivedAt;
+    KeySetT _useKeys;
+
+    GpsdSky _sky;
+    int64_t _skyReceivedAt;
+    unsigned int _done;
+    bool _rejected;
+    bool _lastWasUse;
+};
+
+#endif // GPSDSKYASSEMBLER_H
@@ -0,0 +1,187 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdtransport.h"
+
+#include "gpsdlineframer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace
+{
+
+const int ReadChunk = 4096;
+
+bool connectWithTimeout(int fd, const struct sockaddr* address, socklen_t size, int timeout)
+{
+    if(::connect(fd, address, size) == 0)
+        return true;
+    if(errno != EINPROGRESS)
+        return false;
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    int ready;
+    do
+        ready = poll(&pfd, 1, timeout);
+    while(ready < 0 && errno == EINTR);
+    if(ready <= 0)
+        return false;
+
+    int error = 0;
+    socklen_t errorSize = sizeof(error);
+    return getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &errorSize) == 0 && error == 0;
+}
+
+int64_t monotonicMsecs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+}
+
+GpsdTransport::GpsdTransport()
+    : _fd(-1)
+    , _timeout(0)
+{
+}
+
+GpsdTransport::~GpsdTransport()
+{
+    close();
+}
+
+bool GpsdTransport::open(const std::string& hostname, uint16_t port, int timeout)
+{
+    close();
+    _timeout = timeout;
+
+    char service[8];
+    snprintf(service, sizeof(service), "%u", unsigned(port));
+    struct addrinfo hints = addrinfo();
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* addresses = 0;
+    if(getaddrinfo(hostname.c_str(), service, &hints, &addresses) != 0)
+        return false;
+
+    for(struct addrinfo* it = addresses; it; it = it->ai_next)
+    {
+        int fd = socket(it->ai_family, it->ai_socktype | SOCK_CLOEXEC, it->ai_protocol);
+        if(fd < 0)
+            continue;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        if(connectWithTimeout(fd, it->ai_addr, it->ai_addrlen, timeout))
+        {
+            _fd = fd;
+            break;
+        }
+        ::close(fd);
+    }
+    freeaddrinfo(addresses);
+    return _fd >= 0;
+}
+
+void GpsdTransport::close()
+{
+    if(_fd < 0)
+        return;
+    ::close(_fd);
+    _fd = -1;
+}
+
+bool GpsdTransport::isOpen() const
+{
+    return _fd >= 0;
+}
+
+int GpsdTransport::fd() const
+{
+    return _fd;
+}
+
+bool GpsdTransport::send(const std::string& command)
+{
+    // commands are tiny, wait for socket space rather than queueing, but
+    // not longer than connecting may take; a gpsd that stops reading does
+    // not hang the caller
+    int64_t deadline = monotonicMsecs() + _timeout;
+    size_t sent = 0;
+    while(_fd >= 0 && sent < command.size())
+    {
+        ssize_t result = ::send(_fd, command.data() + sent, command.size() - sent, MSG_NOSIGNAL);
+        if(result > 0)
+            sent += result;
+        else if(result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            int64_t remaining = deadline - monotonicMsecs();
+            if(remaining <= 0)
+                return false;
+            struct pollfd pfd;
+            pfd.fd = _fd;
+            pfd.events = POLLOUT;
+            poll(&pfd, 1, int(remaining));
+        }
+        else if(result < 0 && errno != EINTR)
+            return false;
+    }
+    return _fd >= 0;
+}
+
+int GpsdTransport::read(GpsdLineFramer* framer)
+{
+    if(_fd < 0)
+        return -1;
+    int total = 0;
+    for(;;)
+    {
+        ssize_t got = ::read(_fd, framer->prepare(ReadChunk), ReadChunk);
+        if(got > 0)
+        {
+            framer->commit(int(got));
+            total += int(got);
+            if(got < ReadChunk)
+                return total;
+        }
+        // the end of the connection is reported by the next call, which
+        // hits it again, so that the data before it is not lost
+        else if(got == 0)
+            return total > 0 ? total : -1;
+        else if(errno == EAGAIN || errno == EWOULDBLOCK)
+            return total;
+        else if(errno != EINTR)
+            return total > 0 ? total : -1;
+    }
+}
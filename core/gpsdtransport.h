@@ -0,0 +1,65 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDTRANSPORT_H
+#define GPSDTRANSPORT_H
+
+#include <stdint.h>
+#include <string>
+
+class GpsdLineFramer;
+
+// TCP connection to gpsd on POSIX sockets. The socket is non-blocking once
+// connected, so fd() can be watched by any poll(2) or epoll(7) loop.
+class GpsdTransport
+{
+public:
+    GpsdTransport();
+    ~GpsdTransport();
+
+    // Connects, waiting at most timeout ms.
+    bool open(const std::string& hostname, uint16_t port, int timeout);
+    void close();
+    bool isOpen() const;
+    int fd() const;
+
+    // Sends a command, e.g. GpsdJson::watchCommand(). Fails if gpsd does
+    // not take it within the timeout given to open().
+    bool send(const std::string& command);
+
+    // Reads everything available into framer. Returns the number of bytes
+    // read, or -1 if the connection failed or was closed by gpsd before
+    // anything was read; data read up to then is returned first.
+    int read(GpsdLineFramer* framer);
+
+private:
+    GpsdTransport(const GpsdTransport&);
+    GpsdTransport& operator=(const GpsdTransport&);
+
+    int _fd;
+    int _timeout;
+};
+
+#endif // GPSDTRANSPORT_H
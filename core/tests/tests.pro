@@ -0,0 +1,11 @@
+# Checks of the Qt-free core against fixed input; "make check" runs them
+TARGET = tst_gpsdcore
+CONFIG -= qt app_bundle
+CONFIG += console testcase c++11
+
+TEMPLATE = app
+
+include(../gpsdcore.pri)
+
+SOURCES += \
+    tst_gpsdcore.cpp
@@ -0,0 +1,609 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdepochassembler.h"
+#include "gpsdjson.h"
+#include "gpsdlineframer.h"
+#include "gpsdnmea.h"
+#include "gpsdscenario.h"
+#include "gpsdskyassembler.h"
+
+#ifndef _WIN32
+#include "gpsdclient.h"
+#include "gpsdlogreader.h"
+#include "gpsdrecorder.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace
+{
+
+int failures = 0;
+
+void check(bool condition, const char* expression, const char* file, int line)
+{
+    if(condition)
+        return;
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    ++failures;
+}
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+#define CHECK_NEAR(value, expected, tolerance) \
+    check(std::fabs((value) - (expected)) <= (tolerance), #value " near " #expected, __FILE__, __LINE__)
+
+int length(const char* line)
+{
+    return int(strlen(line));
+}
+
+const char* Rmc = "$GPRMC,123519.00,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*44\r\n";
+const char* Gga = "$GPGGA,123519.00,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*69\r\n";
+const char* Gst = "$GPGST,123519.00,2.0,,,,1.5,1.2,3.0*72\r\n";
+const char* NextRmc = "$GPRMC,123520.00,A,4807.040,N,01131.010,E,022.4,084.4,230394,003.1,W*40\r\n";
+const char* NextGga = "$GPGGA,123520.00,4807.040,N,01131.010,E,1,08,0.9,545.6,M,46.9,M,,*6F\r\n";
+
+const char* GpsGsv1 = "$GPGSV,2,1,06,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45,1*66\r\n";
+const char* GpsGsv2 = "$GPGSV,2,2,06,15,60,120,38,17,10,050,30,1*69\r\n";
+const char* GlonassGsv = "$GLGSV,1,1,02,65,30,100,40,66,20,200,35,1*79\r\n";
+const char* GpsGsa = "$GNGSA,A,3,01,02,12,,,,,,,,,,1.8,1.0,1.5,1*3D\r\n";
+const char* GlonassGsa = "$GNGSA,A,3,65,,,,,,,,,,,,1.8,1.0,1.5,2*3D\r\n";
+const char* LegacyGsa = "$GPGSA,A,3,01,02,,,,,,,,,,,2.0,1.1,1.6*34\r\n";
+// GNGSA before NMEA 4.11: one sentence per system and epoch, without a
+// system ID, and without PRNs for the systems not used
+const char* LegacyGnGsa[] = {
+    "$GNGSA,A,3,01,02,,,,,,,,,,,2.0,1.0,1.5*28\r\n",
+    "$GNGSA,A,3,,,,,,,,,,,,,2.0,1.0,1.5*2B\r\n",
+    "$GNGSA,A,3,03,04,,,,,,,,,,,2.1,1.1,1.5*2C\r\n",
+    "$GNGSA,A,3,,,,,,,,,,,,,2.1,1.1,1.5*2B\r\n",
+    "$GNGSA,A,3,05,06,,,,,,,,,,,2.2,1.2,1.5*28\r\n",
+    "$GNGSA,A,3,,,,,,,,,,,,,2.2,1.2,1.5*2B\r\n"
+};
+
+const char* Tpv = "{\"class\":\"TPV\",\"device\":\"/dev/ttyUSB0\",\"mode\":3,"
+                  "\"time\":\"1994-03-23T12:35:19.000Z\",\"lat\":48.1173,\"lon\":11.5167,"
+                  "\"altMSL\":545.4,\"speed\":11.52,\"track\":84.4,\"eph\":2.5}\n";
+const char* Sky = "{\"class\":\"SKY\",\"device\":\"/dev/ttyUSB0\",\"hdop\":1.0,\"pdop\":1.8,"
+                  "\"satellites\":[{\"PRN\":1,\"el\":40,\"az\":83,\"ss\":46,\"used\":true},"
+                  "{\"PRN\":65,\"el\":30,\"az\":100,\"ss\":40,\"used\":false}]}\n";
+
+void testChecksum()
+{
+    CHECK(GpsdNmea::hasValidChecksum(Rmc, length(Rmc)));
+    CHECK(GpsdNmea::hasValidChecksum(GpsGsv1, length(GpsGsv1)));
+
+    std::string damaged(Rmc);
+    damaged[10] = '7';
+    CHECK(!GpsdNmea::hasValidChecksum(damaged.data(), int(damaged.size())));
+
+    const char* unterminated = "$GPRMC,123519.00,A,4807.038,N";
+    CHECK(!GpsdNmea::hasValidChecksum(unterminated, length(unterminated)));
+}
+
+void testPosition()
+{
+    CHECK(GpsdNmea::isSentence(Rmc, length(Rmc), "RMC"));
+    CHECK(!GpsdNmea::isSentence(Rmc, length(Rmc), "GGA"));
+
+    GpsdFix fix;
+    CHECK(GpsdNmea::decodePosition(Rmc, length(Rmc), &fix));
+    CHECK(fix.hasFix);
+    CHECK(fix.year == 1994 && fix.month == 3 && fix.day == 23);
+    CHECK(fix.timeOfDay == (12 * 3600 + 35 * 60 + 19) * 1000);
+    CHECK_NEAR(fix.latitude, 48.1173, 1e-6);
+    CHECK_NEAR(fix.longitude, 11.5166667, 1e-6);
+    CHECK_NEAR(fix.speed, 22.4 * 1852 / 3600, 1e-6);
+    CHECK_NEAR(fix.course, 84.4, 1e-9);
+    CHECK(!fix.hasAltitude());
+
+    GpsdFix gga;
+    CHECK(GpsdNmea::decodePosition(Gga, length(Gga), &gga));
+    CHECK_NEAR(gga.altitude, 545.4, 1e-9);
+    CHECK(!gga.hasDate());
+
+    GpsdFix gst;
+    CHECK(GpsdNmea::decodePosition(Gst, length(Gst), &gst));
+    CHECK_NEAR(gst.horizontalAccuracy, std::sqrt(1.5 * 1.5 + 1.2 * 1.2), 1e-9);
+    CHECK_NEAR(gst.verticalAccuracy, 3.0, 1e-9);
+
+    std::string damaged(Rmc);
+    damaged[10] = '7';
+    CHECK(!GpsdNmea::decodePosition(damaged.data(), int(damaged.size()), &fix));
+}
+
+void testSkySentences()
+{
+    GpsdNmea::Gsv gsv;
+    CHECK(GpsdNmea::decodeGSV(GpsGsv1, length(GpsGsv1), &gsv));
+    CHECK(gsv.system == GpsdSatellite::Gps);
+    CHECK(gsv.signalId == 1);
+    CHECK(gsv.sentenceCount == 2 && gsv.sentenceIndex == 1);
+    CHECK(gsv.satellitesInView == 6);
+    CHECK(gsv.satelliteCount == 4);
+    CHECK(gsv.satellites[2].prn == 12 && gsv.satellites[2].elevation == 7
+          && gsv.satellites[2].azimuth == 344 && gsv.satellites[2].snr == 39);
+
+    CHECK(GpsdNmea::decodeGSV(GlonassGsv, length(GlonassGsv), &gsv));
+    CHECK(gsv.system == GpsdSatellite::Glonass);
+    CHECK(gsv.satelliteCount == 2);
+
+    // NMEA 4.11 names the system of a GN talker in its last field
+    GpsdNmea::Gsa gsa;
+    CHECK(GpsdNmea::decodeGSA(GlonassGsa, length(GlonassGsa), &gsa));
+    CHECK(gsa.system == GpsdSatellite::Glonass && gsa.systemId == 2);
+    CHECK(gsa.fixMode == GpsdSky::Fix3D);
+    CHECK(gsa.prnCount == 1 && gsa.prns[0] == 65);
+    CHECK_NEAR(gsa.pdop, 1.8, 1e-9);
+
+    CHECK(GpsdNmea::decodeGSA(LegacyGsa, length(LegacyGsa), &gsa));
+    CHECK(gsa.system == GpsdSatellite::Gps && gsa.systemId == 0);
+    CHECK(gsa.prnCount == 2);
+    CHECK_NEAR(gsa.vdop, 1.6, 1e-9);
+
+    CHECK(!GpsdNmea::decodeGSA(Rmc, length(Rmc), &gsa));
+}
+
+void testJson()
+{
+    CHECK(GpsdJson::isClass(Tpv, length(Tpv), "TPV"));
+    CHECK(!GpsdJson::isClass(Tpv, length(Tpv), "SKY"));
+
+    GpsdFix fix;
+    CHECK(GpsdJson::decodeTPV(Tpv, length(Tpv), &fix));
+    CHECK(fix.hasFix);
+    CHECK_NEAR(fix.latitude, 48.1173, 1e-9);
+    CHECK_NEAR(fix.altitude, 545.4, 1e-9);
+    CHECK_NEAR(fix.speed, 11.52, 1e-9);
+    CHECK(fix.year == 1994 && fix.timeOfDay == (12 * 3600 + 35 * 60 + 19) * 1000);
+    CHECK(!GpsdJson::decodeTPV(Sky, length(Sky), &fix));
+
+    GpsdSky sky;
+    CHECK(GpsdJson::decodeSKY(Sky, length(Sky), &sky));
+    CHECK(sky.satelliteCount == 2);
+    CHECK(sky.satellites[0].prn == 1 && sky.satellites[0].used);
+    CHECK(sky.satellites[1].system == GpsdSatellite::Glonass && !sky.satellites[1].used);
+    CHECK_NEAR(sky.hdop, 1.0, 1e-9);
+}
+
+void testFramer()
+{
+    GpsdLineFramer framer(16);
+    const char* line = 0;
+    int size = 0;
+
+    // a line split across two reads is handed out once complete
+    std::string data = std::string(Rmc) + std::string(Gga, 20);
+    memcpy(framer.prepare(int(data.size())), data.data(), data.size());
+    framer.commit(int(data.size()));
+    CHECK(framer.nextLine(&line, &size));
+    CHECK(size == length(Rmc) && memcmp(line, Rmc, size) == 0);
+    CHECK(!framer.nextLine(&line, &size));
+
+    data = std::string(Gga + 20);
+    memcpy(framer.prepare(int(data.size())), data.data(), data.size());
+    framer.commit(int(data.size()));
+    CHECK(framer.nextLine(&line, &size));
+    CHECK(size == length(Gga) && memcmp(line, Gga, size) == 0);
+    CHECK(framer.size() == 0);
+}
+
+void testEpochAssembler()
+{
+    GpsdEpochAssembler assembler;
+    GpsdFix epoch;
+
+    // the first epoch ends when the next one starts
+    CHECK(!assembler.addSentence(Rmc, length(Rmc), 100, &epoch));
+    CHECK(!assembler.addSentence(Gga, length(Gga), 110, &epoch));
+    CHECK(!assembler.addSentence(Gst, length(Gst), 120, &epoch));
+    CHECK(assembler.addSentence(NextRmc, length(NextRmc), 200, &epoch));
+    CHECK(assembler.completedReceivedAt() == 100);
+    CHECK(epoch.hasDate());
+    CHECK_NEAR(epoch.altitude, 545.4, 1e-9);
+    CHECK_NEAR(epoch.verticalAccuracy, 3.0, 1e-9);
+
+    // from then on, it ends with the last sentence type seen before
+    CHECK(!assembler.addSentence(NextGga, length(NextGga), 210, &epoch));
+    CHECK(assembler.flush(&epoch));
+    CHECK_NEAR(epoch.altitude, 545.6, 1e-9);
+    CHECK(assembler.completedReceivedAt() == 200);
+
+    std::string damaged(Rmc);
+    damaged[10] = '7';
+    CHECK(!assembler.addSentence(damaged.data(), int(damaged.size()), 300, &epoch));
+    CHECK(!assembler.rejected());
+}
+
+void testSkyAssembler()
+{
+    GpsdSkyAssembler assembler;
+    const char* epoch[] = { GpsGsv1, GpsGsv2, GlonassGsv, GpsGsa, GlonassGsa };
+    unsigned int completed = 0;
+    for(int i=0; i<5; ++i)
+        completed |= assembler.addSentence(epoch[i], length(epoch[i]), 100 + i);
+    // the first epoch is only known to be complete once it repeats
+    for(int i=0; i<5; ++i)
+        completed |= assembler.addSentence(epoch[i], length(epoch[i]), 200 + i);
+
+    CHECK(completed & GpsdSkyAssembler::SkyCompleted);
+    const GpsdSky& sky = assembler.sky();
+    CHECK(sky.satelliteCount == 8);
+    CHECK(sky.fixMode == GpsdSky::Fix3D);
+    int used = 0;
+    for(int i=0; i<sky.satelliteCount; ++i)
+        used += sky.satellites[i].used ? 1 : 0;
+    CHECK(used == 4);
+    // ordered by system, GPS before GLONASS
+    CHECK(sky.satellites[0].system == GpsdSatellite::Gps && sky.satellites[0].prn == 1);
+    CHECK(sky.satellites[6].system == GpsdSatellite::Glonass && sky.satellites[6].prn == 65);
+    CHECK(sky.satellites[6].used && !sky.satellites[7].used);
+}
+
+void testLegacySkyAssembler()
+{
+    // three epochs of a used system and two empty GNGSA sentences; the
+    // first epoch ends with the used system repeating, the later ones as
+    // soon as their last sentence is in
+    GpsdSkyAssembler assembler;
+    for(int epoch=0; epoch<3; ++epoch)
+    {
+        const char* sentences[] = { LegacyGnGsa[2 * epoch], LegacyGnGsa[2 * epoch + 1],
+                                    LegacyGnGsa[2 * epoch + 1] };
+        for(int i=0; i<3; ++i)
+        {
+            unsigned int completed = assembler.addSentence(sentences[i], length(sentences[i]),
+                                                           epoch * 100 + i);
+            bool expected = epoch == 0 ? false : i == 2 || (epoch == 1 && i == 0);
+            CHECK(bool(completed & GpsdSkyAssembler::UseCompleted) == expected);
+            if(!(completed & GpsdSkyAssembler::UseCompleted))
+                continue;
+            int completedEpoch = epoch == 1 && i == 0 ? 0 : epoch;
+            const GpsdNmea::Gsa& use = assembler.use();
+            CHECK(use.prnCount == 2);
+            CHECK(use.prns[0] == 2 * completedEpoch + 1 && use.prns[1] == 2 * completedEpoch + 2);
+            CHECK_NEAR(use.pdop, 2.0 + completedEpoch * 0.1, 1e-9);
+            CHECK(assembler.useReceivedAt() == completedEpoch * 100);
+        }
+    }
+
+    // without a fix, only the other sentences between the blocks tell the
+    // epochs apart
+    assembler.reset();
+    int completions = 0;
+    for(int epoch=0; epoch<3; ++epoch)
+    {
+        CHECK(!assembler.addSentence(Rmc, length(Rmc), epoch * 100));
+        for(int i=0; i<2; ++i)
+        {
+            unsigned int completed = assembler.addSentence(LegacyGnGsa[1], length(LegacyGnGsa[1]),
+                                                           epoch * 100 + 1 + i);
+            if(completed & GpsdSkyAssembler::UseCompleted)
+                ++completions;
+        }
+    }
+    CHECK(completions == 3);
+    CHECK(assembler.use().prnCount == 0);
+}
+
+void testScenario()
+{
+    GpsdScenario::Options options;
+    options.seed = 7;
+    options.rate = 10;
+    options.satellites = 60;
+    GpsdScenario first(options);
+    GpsdScenario second(options);
+    GpsdEpochAssembler epochAssembler;
+    GpsdSkyAssembler skyAssembler;
+    GpsdLineFramer framer;
+
+    // equal seeds give equal epochs, which decode to what was written
+    int fixes = 0;
+    int skies = 0;
+    for(int i=0; i<20; ++i)
+    {
+        first.next();
+        second.next();
+        std::string text;
+        std::string other;
+        first.appendNmea(&text);
+        second.appendNmea(&other);
+        CHECK(text == other);
+
+        memcpy(framer.prepare(int(text.size())), text.data(), text.size());
+        framer.commit(int(text.size()));
+        const char* line = 0;
+        int size = 0;
+        while(framer.nextLine(&line, &size))
+        {
+            CHECK(GpsdNmea::hasValidChecksum(line, size));
+            GpsdFix fix;
+            if(epochAssembler.addSentence(line, size, i, &fix))
+                ++fixes;
+            if(skyAssembler.addSentence(line, size, i) & GpsdSkyAssembler::SkyCompleted)
+            {
+                ++skies;
+                CHECK(skyAssembler.sky().satelliteCount == 60);
+            }
+        }
+    }
+    CHECK(fixes >= 18);
+    CHECK(skies >= 18);
+}
+
+#ifndef _WIN32
+// lines every 5 ms, alternately from two connections
+const int RecordedLines = 20000;
+const int64_t RecordedInterval = 5000000;
+
+int recordedLine(int i, char* line, int size)
+{
+    return snprintf(line, size, "$TEST,%05d\n", i);
+}
+
+bool isRecordedLine(const GpsdLogReader::Entry& entry, int i)
+{
+    char line[32];
+    int size = recordedLine(i, line, sizeof(line));
+    return entry.receivedAt == 1000 + i * RecordedInterval && entry.tag == 1 + i % 2
+            && entry.size == size && memcmp(entry.data, line, size) == 0;
+}
+
+std::string temporaryFile()
+{
+    char path[] = "/tmp/tst_gpsdcoreXXXXXX";
+    int fd = mkstemp(path);
+    if(fd >= 0)
+        ::close(fd);
+    return path;
+}
+
+void testRecorder()
+{
+    std::string path = temporaryFile();
+    GpsdRecorder recorder;
+    CHECK(recorder.open(path));
+    uint16_t tags[2] = { recorder.sourceTag("localhost:2947"), recorder.sourceTag("localhost:2948") };
+    CHECK(tags[0] == 1 && tags[1] == 2);
+    CHECK(recorder.sourceTag("localhost:2947") == 1);
+    for(int i=0; i<RecordedLines; ++i)
+    {
+        char line[32];
+        int size = recordedLine(i, line, sizeof(line));
+        recorder.record(tags[i % 2], 1000 + i * RecordedInterval, line, size);
+    }
+    recorder.close();
+    CHECK(!recorder.isOpen());
+
+    GpsdLogReader reader;
+    CHECK(reader.open(path));
+    CHECK(reader.format() == GpsdLogReader::BinaryFormat);
+    CHECK(reader.hasIndex());
+    CHECK(reader.startTime() == 1000);
+    GpsdLogReader::Entry entry;
+    int count = 0;
+    bool ordered = true;
+    while(reader.next(&entry))
+        ordered = ordered && isRecordedLine(entry, count++);
+    CHECK(count == RecordedLines);
+    CHECK(ordered);
+    CHECK(reader.sourceName(1) == "localhost:2947" && reader.sourceName(2) == "localhost:2948");
+    CHECK(reader.sourceName(3).empty());
+
+    // before the start, exactly on a line, between lines and past the end
+    CHECK(reader.seek(0) && reader.next(&entry) && isRecordedLine(entry, 0));
+    CHECK(reader.seek(1000 + 12345 * RecordedInterval) && reader.next(&entry)
+          && isRecordedLine(entry, 12345));
+    CHECK(reader.seek(1001 + 12345 * RecordedInterval) && reader.next(&entry)
+          && isRecordedLine(entry, 12346));
+    CHECK(reader.next(&entry) && isRecordedLine(entry, 12347));
+    CHECK(!reader.seek(1001 + (RecordedLines - 1) * RecordedInterval));
+    CHECK(!reader.next(&entry));
+    reader.rewind();
+    CHECK(reader.next(&entry) && isRecordedLine(entry, 0));
+    reader.close();
+
+    // every line takes 32 bytes; the seek jumps to the index point before
+    // the time instead of reading from the start, which here ends at the
+    // zeroed line 100
+    const off_t Line100 = sizeof(GpsdLog::FileHeader) + 2 * 32 + 100 * 32;
+    GpsdLog::EntryHeader header;
+    GpsdLog::EntryHeader zeroed = GpsdLog::EntryHeader();
+    int fd = open(path.c_str(), O_RDWR);
+    CHECK(pread(fd, &header, sizeof(header), Line100) == ssize_t(sizeof(header)));
+    CHECK(pwrite(fd, &zeroed, sizeof(zeroed), Line100) == ssize_t(sizeof(zeroed)));
+    CHECK(reader.open(path) && reader.hasIndex());
+    count = 0;
+    while(reader.next(&entry))
+        ++count;
+    CHECK(count == 100);
+    CHECK(reader.seek(1000 + 12345 * RecordedInterval) && reader.next(&entry)
+          && isRecordedLine(entry, 12345));
+    reader.close();
+    CHECK(pwrite(fd, &header, sizeof(header), Line100) == ssize_t(sizeof(header)));
+    ::close(fd);
+
+    // a log cut off within an entry, as after a crash, has no index and
+    // ends with its last complete line
+    CHECK(truncate(path.c_str(), 4096 + 3) == 0);
+    CHECK(reader.open(path));
+    CHECK(!reader.hasIndex());
+    count = 0;
+    ordered = true;
+    while(reader.next(&entry))
+        ordered = ordered && isRecordedLine(entry, count++);
+    CHECK(count > 100 && count < RecordedLines);
+    CHECK(ordered);
+    CHECK(reader.seek(1000 + 50 * RecordedInterval) && reader.next(&entry)
+          && isRecordedLine(entry, 50));
+    CHECK(!reader.seek(1000 + count * RecordedInterval));
+    reader.close();
+    unlink(path.c_str());
+}
+
+void testTextLog()
+{
+    // timed by the fix times, relative to the first one
+    std::string path = temporaryFile();
+    std::string log = std::string(Rmc) + Gga + GpsGsv1 + NextRmc + NextGga;
+    FILE* file = fopen(path.c_str(), "w");
+    CHECK(file && fwrite(log.data(), 1, log.size(), file) == log.size());
+    if(file)
+        fclose(file);
+
+    GpsdLogReader reader;
+    CHECK(reader.open(path));
+    CHECK(reader.format() == GpsdLogReader::NmeaFormat);
+    CHECK(!reader.hasIndex());
+    const int64_t times[] = { 0, 0, 0, 1000000000, 1000000000 };
+    GpsdLogReader::Entry entry;
+    int count = 0;
+    while(reader.next(&entry) && count < 5)
+    {
+        CHECK(entry.receivedAt == times[count] && entry.tag == 0);
+        ++count;
+    }
+    CHECK(count == 5);
+    CHECK(reader.seek(500000000) && reader.next(&entry) && entry.size == length(NextRmc)
+          && memcmp(entry.data, NextRmc, entry.size) == 0);
+    CHECK(!reader.seek(2000000000));
+
+    file = fopen(path.c_str(), "w");
+    CHECK(file && fputs(Tpv, file) >= 0);
+    if(file)
+        fclose(file);
+    CHECK(reader.open(path));
+    CHECK(reader.format() == GpsdLogReader::JsonFormat);
+    CHECK(reader.next(&entry) && entry.receivedAt == 0);
+    reader.close();
+    unlink(path.c_str());
+}
+
+void testTransport()
+{
+    // a gpsd that accepts but never reads fails a send within the timeout
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address = sockaddr_in();
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressSize = sizeof(address);
+    CHECK(bind(server, reinterpret_cast<struct sockaddr*>(&address), addressSize) == 0);
+    CHECK(listen(server, 1) == 0);
+    CHECK(getsockname(server, reinterpret_cast<struct sockaddr*>(&address), &addressSize) == 0);
+
+    GpsdTransport transport;
+    CHECK(transport.open("127.0.0.1", ntohs(address.sin_port), 200));
+    int peer = accept(server, 0, 0);
+    CHECK(peer >= 0);
+    int64_t start = GpsdClient::monotonicNsecs();
+    CHECK(!transport.send(std::string(64 << 20, ' ')));
+    int64_t elapsed = GpsdClient::monotonicNsecs() - start;
+    CHECK(elapsed >= 150000000 && elapsed < 2000000000);
+    transport.close();
+    ::close(peer);
+    ::close(server);
+}
+
+void testClient()
+{
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address = sockaddr_in();
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressSize = sizeof(address);
+    CHECK(bind(server, reinterpret_cast<struct sockaddr*>(&address), addressSize) == 0);
+    CHECK(listen(server, 1) == 0);
+    CHECK(getsockname(server, reinterpret_cast<struct sockaddr*>(&address), &addressSize) == 0);
+
+    GpsdClient client(GpsdClient::JsonMode);
+    CHECK(client.open("127.0.0.1", ntohs(address.sin_port)));
+    int peer = accept(server, 0, 0);
+    CHECK(peer >= 0);
+
+    // the last reports before gpsd goes away are delivered, the end of the
+    // connection only after them
+    std::string reports = std::string(Tpv) + Sky + Tpv;
+    CHECK(write(peer, reports.data(), reports.size()) == ssize_t(reports.size()));
+    ::close(peer);
+    ::close(server);
+
+    struct pollfd pfd;
+    pfd.fd = client.fd();
+    pfd.events = POLLIN;
+    CHECK(poll(&pfd, 1, 1000) == 1);
+
+    // a full array leaves the rest buffered, with the stamp of its read
+    GpsdClient::Record records[2];
+    CHECK(client.readRecords(records, 2) == 2);
+    CHECK(records[0].type == GpsdClient::Record::Fix && records[1].type == GpsdClient::Record::Sky);
+    int64_t receivedAt = records[0].receivedAt;
+    CHECK(client.readRecords(records, 2) == 1);
+    CHECK(records[0].type == GpsdClient::Record::Fix);
+    CHECK(records[0].receivedAt == receivedAt);
+    CHECK(client.readRecords(records, 2) == -1);
+    CHECK(!client.isOpen());
+}
+#endif
+
+}
+
+int main()
+{
+    testChecksum();
+    testPosition();
+    testSkySentences();
+    testJson();
+    testFramer();
+    testEpochAssembler();
+    testSkyAssembler();
+    testLegacySkyAssembler();
+    testScenario();
+#ifndef _WIN32
+    testRecorder();
+    testTextLog();
+    testTransport();
+    testClient();
+#endif
+
+    if(failures)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
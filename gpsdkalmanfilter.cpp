@@ -0,0 +1,212 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdkalmanfilter.h"
+
+#include <qmath.h>
+
+namespace
+{
+
+const double EarthRadius = 6371000.0;
+
+// used if the receiver does not report error estimates
+const qreal DefaultHorizontalAccuracy = 5.0;
+const qreal DefaultVerticalAccuracy = 10.0;
+const qreal VelocityAccuracy = 0.5;
+
+// fixes further apart restart the filter
+const qreal MaxTimeStep = 10.0;
+
+}
+
+void GpsdKalmanFilter::Axis::init(qreal position, qreal velocity,
+                                  qreal positionVariance, qreal velocityVariance)
+{
+    p = position;
+    v = velocity;
+    ppp = positionVariance;
+    ppv = 0;
+    pvv = velocityVariance;
+}
+
+void GpsdKalmanFilter::Axis::predict(qreal dt, qreal q)
+{
+    // x = F x, P = F P F' + Q with F = [1 dt; 0 1]
+    p += v * dt;
+    ppp += dt * (2 * ppv + dt * pvv) + q * dt * dt * dt / 3;
+    ppv += dt * pvv + q * dt * dt / 2;
+    pvv += q * dt;
+}
+
+void GpsdKalmanFilter::Axis::updatePosition(qreal z, qreal r)
+{
+    qreal s = ppp + r;
+    qreal kp = ppp / s;
+    qreal kv = ppv / s;
+    qreal y = z - p;
+    p += kp * y;
+    v += kv * y;
+    pvv -= kv * ppv;
+    ppv -= kv * ppp;
+    ppp -= kp * ppp;
+}
+
+void GpsdKalmanFilter::Axis::updateVelocity(qreal z, qreal r)
+{
+    qreal s = pvv + r;
+    qreal kp = ppv / s;
+    qreal kv = pvv / s;
+    qreal y = z - v;
+    p += kp * y;
+    v += kv * y;
+    ppp -= kp * ppv;
+    ppv -= kp * pvv;
+    pvv -= kv * pvv;
+}
+
+GpsdKalmanFilter::GpsdKalmanFilter()
+    : _initialized(false)
+    , _hasAltitude(false)
+    , _lastReceivedAt(0)
+    , _processNoise(1.0)
+{
+}
+
+void GpsdKalmanFilter::setProcessNoise(qreal processNoise)
+{
+    _processNoise = processNoise;
+}
+
+qreal GpsdKalmanFilter::processNoise() const
+{
+    return _processNoise;
+}
+
+void GpsdKalmanFilter::reset()
+{
+    _initialized = false;
+}
+
+QGeoPositionInfo GpsdKalmanFilter::filter(const QGeoPositionInfo& info, qint64 receivedAt)
+{
+    const QGeoCoordinate& coordinate = info.coordinate();
+    if(!coordinate.isValid())
+        return info;
+
+    // receiver time if available, it does not suffer from delivery jitter
+    qreal dt = 0;
+    if(_initialized)
+    {
+        if(_lastTimestamp.isValid() && info.timestamp().isValid())
+            dt = _lastTimestamp.msecsTo(info.timestamp()) / 1000.0;
+        else
+            dt = (receivedAt - _lastReceivedAt) / 1e9;
+        if(dt < 0 || dt > MaxTimeStep)
+            _initialized = false;
+    }
+    _lastTimestamp = info.timestamp();
+    _lastReceivedAt = receivedAt;
+
+    qreal hacc = info.hasAttribute(QGeoPositionInfo::HorizontalAccuracy)
+            ? info.attribute(QGeoPositionInfo::HorizontalAccuracy) : DefaultHorizontalAccuracy;
+    qreal vacc = info.hasAttribute(QGeoPositionInfo::VerticalAccuracy)
+            ? info.attribute(QGeoPositionInfo::VerticalAccuracy) : DefaultVerticalAccuracy;
+    // the horizontal accuracy is radial, split it evenly on both axes
+    qreal rh = hacc * hacc / 2;
+    qreal rv = vacc * vacc;
+    qreal rvel = VelocityAccuracy * VelocityAccuracy;
+
+    bool hasVelocity = info.hasAttribute(QGeoPositionInfo::GroundSpeed)
+            && info.hasAttribute(QGeoPositionInfo::Direction);
+    qreal course = qDegreesToRadians(info.attribute(QGeoPositionInfo::Direction));
+    qreal speed = info.attribute(QGeoPositionInfo::GroundSpeed);
+    bool hasClimb = info.hasAttribute(QGeoPositionInfo::VerticalSpeed);
+    bool hasAltitude = coordinate.type() == QGeoCoordinate::Coordinate3D;
+
+    if(!_initialized || hasAltitude != _hasAltitude)
+    {
+        _reference = coordinate;
+        _hasAltitude = hasAltitude;
+        _east.init(0, hasVelocity ? speed * qSin(course) : 0, rh, hasVelocity ? rvel : 100);
+        _north.init(0, hasVelocity ? speed * qCos(course) : 0, rh, hasVelocity ? rvel : 100);
+        _up.init(hasAltitude ? coordinate.altitude() : 0,
+                 hasClimb ? info.attribute(QGeoPositionInfo::VerticalSpeed) : 0,
+                 rv, hasClimb ? rvel : 100);
+        _initialized = true;
+        return info;
+    }
+
+    double cosLat = qCos(qDegreesToRadians(_reference.latitude()));
+    qreal east = qDegreesToRadians(coordinate.longitude() - _reference.longitude()) * EarthRadius * cosLat;
+    qreal north = qDegreesToRadians(coordinate.latitude() - _reference.latitude()) * EarthRadius;
+
+    _east.predict(dt, _processNoise);
+    _north.predict(dt, _processNoise);
+    _east.updatePosition(east, rh);
+    _north.updatePosition(north, rh);
+    if(hasVelocity)
+    {
+        _east.updateVelocity(speed * qSin(course), rvel);
+        _north.updateVelocity(speed * qCos(course), rvel);
+    }
+    if(hasAltitude)
+    {
+        _up.predict(dt, _processNoise);
+        _up.updatePosition(coordinate.altitude(), rv);
+        if(hasClimb)
+            _up.updateVelocity(info.attribute(QGeoPositionInfo::VerticalSpeed), rvel);
+    }
+
+    QGeoPositionInfo result = info;
+    QGeoCoordinate filtered(_reference.latitude() + qRadiansToDegrees(_north.p / EarthRadius),
+                            _reference.longitude() + qRadiansToDegrees(_east.p / (EarthRadius * cosLat)));
+    if(hasAltitude)
+        filtered.setAltitude(_up.p);
+    result.setCoordinate(filtered);
+
+    qreal groundSpeed = qSqrt(_east.v * _east.v + _north.v * _north.v);
+    result.setAttribute(QGeoPositionInfo::GroundSpeed, groundSpeed);
+    if(groundSpeed > 0)
+    {
+        qreal direction = qRadiansToDegrees(qAtan2(_east.v, _north.v));
+        result.setAttribute(QGeoPositionInfo::Direction, direction < 0 ? direction + 360 : direction);
+    }
+    result.setAttribute(QGeoPositionInfo::HorizontalAccuracy, qSqrt(_east.ppp + _north.ppp));
+    if(hasAltitude)
+    {
+        result.setAttribute(QGeoPositionInfo::VerticalAccuracy, qSqrt(_up.ppp));
+        result.setAttribute(QGeoPositionInfo::VerticalSpeed, _up.v);
+    }
+
+    // move the reference along so the flat earth approximation holds
+    if(qAbs(_east.p) > 10000 || qAbs(_north.p) > 10000)
+    {
+        _reference = QGeoCoordinate(filtered.latitude(), filtered.longitude());
+        _east.p = 0;
+        _north.p = 0;
+    }
+    return result;
+}
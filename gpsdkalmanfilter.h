@@ -0,0 +1,77 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDKALMANFILTER_H
+#define GPSDKALMANFILTER_H
+
+#include <QGeoPositionInfo>
+
+// Constant velocity Kalman filter smoothing position and velocity of the
+// fixes of one source. East, north and up are filtered independently in
+// a local tangent plane around the first fix, each with a state of
+// position and velocity, which keeps an update at a few dozen flops.
+//
+// Position measurements are weighted by the receiver's error estimates
+// (HorizontalAccuracy and VerticalAccuracy, e.g. from GST), speed and
+// course measurements with a fixed uncertainty.
+class GpsdKalmanFilter
+{
+public:
+    GpsdKalmanFilter();
+
+    // spectral density of the acceleration noise in m^2/s^3
+    void setProcessNoise(qreal processNoise);
+    qreal processNoise() const;
+
+    QGeoPositionInfo filter(const QGeoPositionInfo& info, qint64 receivedAt);
+    void reset();
+
+private:
+    struct Axis
+    {
+        qreal p;      // position, meters from the reference
+        qreal v;      // velocity, meters per second
+        qreal ppp;    // covariance
+        qreal ppv;
+        qreal pvv;
+
+        void init(qreal position, qreal velocity, qreal positionVariance, qreal velocityVariance);
+        void predict(qreal dt, qreal q);
+        void updatePosition(qreal z, qreal r);
+        void updateVelocity(qreal z, qreal r);
+    };
+
+    bool _initialized;
+    bool _hasAltitude;
+    QGeoCoordinate _reference;
+    qint64 _lastReceivedAt;
+    QDateTime _lastTimestamp;
+    qreal _processNoise;
+    Axis _east;
+    Axis _north;
+    Axis _up;
+};
+
+#endif // GPSDKALMANFILTER_H
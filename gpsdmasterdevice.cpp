@@ -25,80 +25,441 @@
 
 #include "gpsdmasterdevice.h"
 
+#include "gpsdjson.h"
+#include "gpsdmetrics.h"
+#include "gpsdnmea.h"
+#include "gpsdscenario.h"
+#include "gpsdslavedevice.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutexLocker>
 #include <QTcpSocket>
-#include <QBuffer>
+#include <QThread>
+#include <QTimer>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include "gpsdrecorder.h"
+
+#include <time.h>
+#endif
+
+GpsdMasterDevice::MasterHashT GpsdMasterDevice::_masters;
+QMutex GpsdMasterDevice::_mastersMutex;
+
+namespace
+{
 
-GpsdMasterDevice* GpsdMasterDevice::_instance = 0;
+// at maximum speed, a replay hands over to the event loop after this much
+const int MaxReplayBatch = 65536;
 
-GpsdMasterDevice* GpsdMasterDevice::instance()
+// chunks in use by slaves lagging behind beyond that are not pooled
+const int MaxPooledChunks = 16;
+
+bool isFresh(qint64 receivedAt, int maxAge)
+{
+    return GpsdMasterDevice::monotonicNsecs() - receivedAt <= qint64(maxAge) * 1000000;
+}
+
+#ifdef Q_OS_UNIX
+// all masters of the process record into the file named by GPSD_RECORD
+GpsdRecorder* openRecorder()
+{
+    QByteArray path = qgetenv("GPSD_RECORD");
+    if(path.isEmpty())
+        return 0;
+    static GpsdRecorder recorder;
+    if(!recorder.open(path.constData()))
+    {
+        qCritical() << "Could not open gpsd record file" << path;
+        return 0;
+    }
+#ifndef QT_NO_DEBUG
+    qInfo() << "Recording gpsd data to" << path;
+#endif
+    return &recorder;
+}
+#else
+QElapsedTimer startedTimer()
 {
-    if(!_instance)
-        _instance = new GpsdMasterDevice;
-    return _instance;
+    QElapsedTimer timer;
+    timer.start();
+    return timer;
 }
+#endif
 
-GpsdMasterDevice::GpsdMasterDevice()
+}
+
+GpsdMasterDevice* GpsdMasterDevice::acquire(const GpsdSourceParameters& parameters)
+{
+    QMutexLocker locker(&_mastersMutex);
+    QString key = parameters.connectionKey();
+    GpsdMasterDevice* master = _masters.value(key);
+    if(!master)
+    {
+        master = new GpsdMasterDevice(parameters);
+        master->_key = key;
+        // the socket must not depend on the lifetime of a worker thread
+        if(QCoreApplication::instance())
+            master->moveToThread(QCoreApplication::instance()->thread());
+        _masters.insert(key, master);
+    }
+    ++master->_refCount;
+    return master;
+}
+
+void GpsdMasterDevice::release(GpsdMasterDevice* master)
+{
+    if(!master)
+        return;
+    QMutexLocker locker(&_mastersMutex);
+    if(--master->_refCount > 0)
+        return;
+    _masters.remove(master->_key);
+    // the master may be reading from its socket right now
+    master->deleteLater();
+}
+
+const GpsdSourceParameters& GpsdMasterDevice::parameters() const
+{
+    return _parameters;
+}
+
+qint64 GpsdMasterDevice::monotonicNsecs()
+{
+#ifdef Q_OS_UNIX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    static const QElapsedTimer timer = startedTimer();
+    return timer.nsecsElapsed();
+#endif
+}
+
+GpsdMasterDevice::GpsdMasterDevice(const GpsdSourceParameters& parameters)
     : _socket( new QTcpSocket(this))
-    , _hostname("localhost")
-    , _port(2947)
+    , _parameters(parameters)
+    , _refCount(0)
     , _gpsdStarted(false)
-    , _timeout(1000)
+    , _wasConnected(false)
+    , _lingerTimer(new QTimer(this))
+    , _cacheMaxAge(1000)
+    , _gsaPosition(0)
+    , _lastPositionReceived(0)
+    , _lastSnapshotReceived(0)
+    , _recorder(0)
+    , _recordTag(0)
+    , _replay(0)
+    , _replayTimer(new QTimer(this))
+    , _replayPending(false)
+    , _replayTag(0)
+    , _replayStart(0)
+    , _replayOrigin(0)
+    , _scenario(0)
 {
+    qRegisterMetaType<QIODevice*>();
+    qRegisterMetaType<QThread*>();
+    qRegisterMetaType<GpsdSlaveDevice*>();
+    _lingerTimer->setSingleShot(true);
+    _lingerTimer->setInterval(5000);
+    connect(_lingerTimer, SIGNAL( timeout()), this, SLOT( lingerTimeout()));
     connect(_socket, SIGNAL( readyRead()), this, SLOT( readFromSocketAndCopy()));
-    QByteArray hostname = qgetenv("GPSD_HOST");
-    if( !hostname.isEmpty())
-        _hostname = hostname;
-    QByteArray port = qgetenv("GPSD_PORT");
-    if( !port.isEmpty())
+    _replayTimer->setSingleShot(true);
+    _replayTimer->setTimerType(Qt::PreciseTimer);
+    connect(_replayTimer, SIGNAL( timeout()), this, SLOT( replayNext()));
+    QByteArray linger = qgetenv("GPSD_LINGER");
+    if( !linger.isEmpty())
     {
         bool ok = false;
-        uint tmp = port.toUInt(&ok);
+        int tmp = linger.toInt(&ok);
         if(ok)
-            _port = tmp;
+            _lingerTimer->setInterval(tmp);
     }
+    QByteArray cacheMaxAge = qgetenv("GPSD_CACHE_MAX_AGE");
+    if( !cacheMaxAge.isEmpty())
+    {
+        bool ok = false;
+        int tmp = cacheMaxAge.toInt(&ok);
+        if(ok)
+            _cacheMaxAge = tmp;
+    }
+#ifdef Q_OS_UNIX
+    static GpsdRecorder* recorder = openRecorder();
+    if(recorder)
+    {
+        _recorder = recorder;
+        _recordTag = recorder->sourceTag(parameters.connectionKey().toStdString());
+    }
+#endif
+}
+
+GpsdMasterDevice::~GpsdMasterDevice()
+{
+    gpsdStop();
+    gpsdDisconnect();
+#ifdef Q_OS_UNIX
+    delete _replay;
+#endif
+#ifndef QT_NO_DEBUG
+    qInfo() << "Destroyed master" << _key;
+#endif
 }
 
 void GpsdMasterDevice::readFromSocketAndCopy()
 {
-    bool gotNewData = false;
-    QByteArray buf;
+    qint64 available = _socket->bytesAvailable();
+    if(available <= 0)
+        return;
+    qint64 receivedAt = monotonicNsecs();
+
+    qint64 got = _socket->read(_framer.prepare(int(available)), available);
+    _framer.commit(int(qMax(got, qint64(0))));
+    forwardLines(receivedAt);
+}
+
+void GpsdMasterDevice::forwardLines(qint64 receivedAt)
+{
+    // only complete lines are forwarded, a partial line waits for the rest
+    int end = _framer.completeSize();
+    if(end == 0)
+        return;
+    const char* data = _framer.data();
+    bool metrics = GpsdMetrics::isEnabled();
+
+    if(_cacheMaxAge > 0 || _recorder || metrics)
+    {
+        QMutexLocker locker(_cacheMaxAge > 0 ? &_cacheMutex : 0);
+        int start = 0;
+        qint64 lines = 0;
+        qint64 checksumFailures = 0;
+        while(start < end)
+        {
+            const char* eol = static_cast<const char*>(memchr(data + start, '\n', end - start));
+            int next = int(eol - data) + 1;
+            if(metrics)
+            {
+                ++lines;
+                if(data[start] == '$' && !GpsdNmea::hasValidChecksum(data + start, next - start))
+                    ++checksumFailures;
+            }
+#ifdef Q_OS_UNIX
+            if(_recorder)
+                _recorder->record(_recordTag, receivedAt, data + start, next - start);
+#endif
+            if(_cacheMaxAge > 0)
+                cacheSentence(data + start, next - start, receivedAt);
+            start = next;
+        }
+        if(metrics)
+        {
+            GpsdMetrics::add(GpsdMetrics::BytesReceived, end);
+            GpsdMetrics::add(GpsdMetrics::LinesReceived, lines);
+            GpsdMetrics::add(GpsdMetrics::ChecksumFailures, checksumFailures);
+        }
+    }
+
+    // all lines of a read are copied once and shared by the slaves; paused
+    // slaves miss them
+    SlaveListT slaves = _slaves;
     SlaveListT::iterator it;
-    for( it=_slaves.begin(); it!=_slaves.end(); ++it)
+    QByteArray chunk;
+    if(!isIdle())
+        chunk = sharedChunk(data, end);
+    for( it=slaves.begin(); it!=slaves.end(); ++it)
     {
         if(it->second)
-            it->first->seek(0);
+            it->first->appendData(chunk, receivedAt);
+        else if(metrics)
+            it->first->countDropped(end);
     }
-    while(_socket->canReadLine())
+    _framer.consume(end);
+
+    // high-rate sources of this thread parse right away; a source may pause
+    // or destroy its slave from there, hence the check against _slaves
+    for( it=slaves.begin(); it!=slaves.end(); ++it)
     {
-        gotNewData = true;
-        buf = _socket->readLine();
-        for( it=_slaves.begin(); it!=_slaves.end(); ++it)
+        if(it->second && _slaves.contains(*it))
+            it->first->notifyReadyRead();
+    }
+}
+
+QByteArray GpsdMasterDevice::sharedChunk(const char* data, int size)
+{
+    QList<QByteArray>::iterator it = _chunkPool.begin();
+    for(; it!=_chunkPool.end(); ++it)
+    {
+        // no slave refers to it any more; the reserved capacity survives
+        // the resize
+        if(it->isDetached())
         {
-            if(it->second)
-                it->first->write(buf);
+            it->resize(size);
+            memcpy(it->data(), data, size);
+            return *it;
         }
     }
-    if( gotNewData)
+
+    QByteArray chunk;
+    chunk.reserve(qMax(size, 1024));
+    chunk.append(data, size);
+    if(_chunkPool.size() < MaxPooledChunks)
+        _chunkPool.append(chunk);
+    return chunk;
+}
+
+void GpsdMasterDevice::cacheSentence(const char* data, int size, qint64 receivedAt)
+{
+    // $GPRMC,... is cached as "GPRMC"; a receiver sends a GSA sentence per
+    // system and a GSV cycle per system and signal in each epoch, so these
+    // are cached per system ("GNGSA1") and signal ("GPGSV1"). GNGSA
+    // sentences without a system ID are cached by their position in their
+    // block ("GNGSAa").
+    bool isGsa = GpsdNmea::isSentence(data, size, "GSA");
+    int gsaPosition = isGsa ? _gsaPosition++ : 0;
+    if(!isGsa)
+        _gsaPosition = 0;
+    if(size < 7 || data[0] != '$')
+        return;
+    char key[6];
+    memcpy(key, data + 1, 5);
+    int keySize = 5;
+    bool cycleStart = true;
+    if(isGsa)
+    {
+        GpsdNmea::Gsa gsa;
+        if(!GpsdNmea::decodeGSA(data, size, &gsa))
+            return;
+        if(gsa.systemId == 0
+                && GpsdNmea::talkerSystem(data, size) == GpsdSatellite::UnknownSystem)
+            key[keySize++] = char('a' + qMin(gsaPosition, 25));
+        else
+            key[keySize++] = "0123456789ABCDEF"[gsa.system & 0xf];
+    }
+    else if(GpsdNmea::isSentence(data, size, "GSV"))
     {
-        for( it=_slaves.begin(); it!=_slaves.end(); ++it)
+        GpsdNmea::Gsv gsv;
+        if(!GpsdNmea::decodeGSV(data, size, &gsv))
+            return;
+        key[keySize++] = "0123456789ABCDEF"[gsv.signalId & 0xf];
+        cycleStart = gsv.sentenceIndex <= 1;
+    }
+
+    // looked up without copying the key, which is copied on first use only
+    SentenceCacheT::iterator it = _sentenceCache.find(QByteArray::fromRawData(key, keySize));
+    if(it == _sentenceCache.end())
+    {
+        CachedSentencesT empty;
+        empty.count = 0;
+        it = _sentenceCache.insert(QByteArray(key, keySize), empty);
+    }
+    CachedSentencesT& entry = *it;
+    entry.received = receivedAt;
+
+    // a GSV cycle spans several sentences and restarts with sentence 1
+    int index = cycleStart ? 0 : entry.count;
+
+    // the sentences of the previous cycle are overwritten in place
+    if(index < entry.sentences.size())
+    {
+        QByteArray& sentence = entry.sentences[index];
+        sentence.resize(size);
+        memcpy(sentence.data(), data, size);
+    }
+    else
+        entry.sentences.append(QByteArray(data, size));
+    entry.count = index + 1;
+}
+
+QList<QByteArray> GpsdMasterDevice::recentSentences(const char* type, int maxAge,
+                                                   qint64* receivedAt) const
+{
+    QMutexLocker locker(&_cacheMutex);
+    QList<QByteArray> result;
+    SentenceCacheT::const_iterator it = _sentenceCache.constBegin();
+    for(; it!=_sentenceCache.constEnd(); ++it)
+    {
+        // the type follows the talker
+        if(qstrncmp(it.key().constData() + 2, type, 3) == 0 && isFresh(it->received, maxAge))
         {
-            if(it->second)
-                it->first->seek(0);
+            if(receivedAt && (result.isEmpty() || it->received < *receivedAt))
+                *receivedAt = it->received;
+            result.append(it->sentences.mid(0, it->count));
         }
     }
+    return result;
+}
+
+int GpsdMasterDevice::cacheMaxAge() const
+{
+    return _cacheMaxAge;
+}
+
+void GpsdMasterDevice::setLastKnownPosition(const QGeoPositionInfo& info, qint64 receivedAt)
+{
+    QMutexLocker locker(&_cacheMutex);
+    _lastPosition = info;
+    _lastPositionReceived = receivedAt;
+}
+
+QGeoPositionInfo GpsdMasterDevice::lastKnownPosition(int maxAge, qint64* receivedAt) const
+{
+    QMutexLocker locker(&_cacheMutex);
+    if(maxAge >= 0 && !isFresh(_lastPositionReceived, maxAge))
+        return QGeoPositionInfo();
+    if(receivedAt)
+        *receivedAt = _lastPositionReceived;
+    return _lastPosition;
+}
+
+void GpsdMasterDevice::setLastSatelliteSnapshot(const GpsdSatelliteSnapshot& snapshot, qint64 receivedAt)
+{
+    QMutexLocker locker(&_cacheMutex);
+    _lastSnapshot = snapshot;
+    _lastSnapshotReceived = receivedAt;
+}
+
+GpsdSatelliteSnapshot GpsdMasterDevice::lastSatelliteSnapshot(int maxAge, qint64* receivedAt) const
+{
+    QMutexLocker locker(&_cacheMutex);
+    if(maxAge >= 0 && !isFresh(_lastSnapshotReceived, maxAge))
+        return GpsdSatelliteSnapshot();
+    if(receivedAt)
+        *receivedAt = _lastSnapshotReceived;
+    return _lastSnapshot;
+}
+
+bool GpsdMasterDevice::isConnected() const
+{
+#ifdef Q_OS_UNIX
+    if(_scenario)
+        return true;
+    if(_replay)
+        return _replay->isOpen();
+#endif
+    return _socket->isOpen();
 }
 
 bool GpsdMasterDevice::gpsdConnect()
 {
-    if( _socket->isOpen())
+    if( isConnected())
     {
 #ifndef QT_NO_DEBUG
         qInfo() << "Already connected to gpsd";
 #endif
         return true;
     }
-    _socket->connectToHost(_hostname, _port);
-    if( !_socket->waitForConnected(_timeout))
+    if(_parameters.transport == "replay")
+        return replayOpen();
+    if(_parameters.transport != "tcp")
+    {
+        qCritical() << "Unknown gpsd transport" << _parameters.transport;
+        return false;
+    }
+    _socket->connectToHost(_parameters.hostname, _parameters.port);
+    if( !_socket->waitForConnected(_parameters.timeout))
     {
         _socket->close();
         qCritical() << "Could not open connection to gpsd";
@@ -108,30 +469,49 @@ bool GpsdMasterDevice::gpsdConnect()
 #ifndef QT_NO_DEBUG
     qInfo() << "Connected to gpsd";
 #endif
+    if(_wasConnected && GpsdMetrics::isEnabled())
+        GpsdMetrics::add(GpsdMetrics::Reconnects);
+    _wasConnected = true;
     return true;
 }
 
 void GpsdMasterDevice::gpsdDisconnect()
 {
-    if( !_socket->isOpen())
+    if( !isConnected())
         return;
 #ifndef QT_NO_DEBUG
     qInfo() << "Disconnecting from gpsd";
 #endif
+    _replayTimer->stop();
+#ifdef Q_OS_UNIX
+    if(_replay)
+        _replay->close();
+#endif
+    delete _scenario;
+    _scenario = 0;
+    _replayPending = false;
     _socket->close();
+    _gpsdStarted = false;
+    _framer.clear();
 }
 
 bool GpsdMasterDevice::gpsdStart()
 {
-    if(!_socket->isOpen())
+    if(!isConnected())
         return false;
 
-    if(!_gpsdStarted)
+    if(!_gpsdStarted && (_replay || _scenario))
+    {
+        replayStart();
+        _gpsdStarted = true;
+    }
+    else if(!_gpsdStarted)
     {
 #ifndef QT_NO_DEBUG
         qInfo() << "Starting gpsd";
 #endif
-        _socket->write("?WATCH={\"enable\":true, \"nmea\":true}\n");
+        bool json = _parameters.mode == GpsdSourceParameters::JsonMode;
+        _socket->write(GpsdJson::watchCommand(true, json, _parameters.device.toStdString()).c_str());
         _gpsdStarted = true;
     }
     return true;
@@ -139,34 +519,218 @@ bool GpsdMasterDevice::gpsdStart()
 
 bool GpsdMasterDevice::gpsdStop()
 {
-    if(!_socket->isOpen())
+    if(!isConnected())
         return false;
 
-    if(_gpsdStarted)
+    if(_gpsdStarted && (_replay || _scenario))
+    {
+        _replayTimer->stop();
+        _gpsdStarted = false;
+    }
+    else if(_gpsdStarted)
     {
 #ifndef QT_NO_DEBUG
         qInfo() << "Stopping gpsd";
 #endif
-        _socket->write("?WATCH={\"enable\": false}\n");
+        _socket->write(GpsdJson::watchCommand(false).c_str());
         _gpsdStarted = false;
     }
     return true;
 }
 
-QIODevice* GpsdMasterDevice::createSlave()
+bool GpsdMasterDevice::isIdle() const
+{
+    SlaveListT::const_iterator it = _slaves.begin();
+    for(; it!=_slaves.end(); ++it)
+    {
+        if(it->second)
+            return false;
+    }
+    return true;
+}
+
+bool GpsdMasterDevice::replayOpen()
+{
+#ifdef Q_OS_UNIX
+    if(_parameters.scenario)
+    {
+        // the scenario starts now, so that the sources see current fixes
+        GpsdScenario::Options options;
+        options.seed = _parameters.seed;
+        options.rate = _parameters.rate;
+        options.satellites = _parameters.satellites;
+        options.startTime = QDateTime::currentMSecsSinceEpoch();
+        _scenario = new GpsdScenario(options);
+        do
+            _replayPending = replayFetch();
+        while(_replayEntry.receivedAt < _parameters.start * 1000000);
+        _replayTag = _replayEntry.tag;
+#ifndef QT_NO_DEBUG
+        qInfo() << "Replaying scenario" << _parameters.seed << "at speed" << _parameters.speed;
+#endif
+        return true;
+    }
+
+    if(!_replay)
+        _replay = new GpsdLogReader;
+    if(!_replay->open(QFile::encodeName(_parameters.file).constData()))
+    {
+        qCritical() << "Could not open gpsd log" << _parameters.file;
+        return false;
+    }
+    if(_parameters.start > 0)
+        _replay->seek(_replay->startTime() + _parameters.start * 1000000);
+    // a log recorded from several connections replays the first of them
+    _replayPending = replayFetch();
+    _replayTag = _replayEntry.tag;
+#ifndef QT_NO_DEBUG
+    qInfo() << "Replaying" << _parameters.file << "at speed" << _parameters.speed;
+#endif
+    return true;
+#else
+    qCritical() << "Replaying gpsd logs is not supported on this platform";
+    return false;
+#endif
+}
+
+void GpsdMasterDevice::replayStart()
+{
+    // the pending entry is due right away, the others relative to it
+    _replayStart = monotonicNsecs();
+    _replayOrigin = _replayPending ? _replayEntry.receivedAt : 0;
+    replayNext();
+}
+
+void GpsdMasterDevice::replayNext()
+{
+#ifdef Q_OS_UNIX
+    if(!_replay && !_scenario)
+        return;
+    qint64 now = monotonicNsecs();
+    double speed = _parameters.speed;
+    int copied = 0;
+    while(_replayPending)
+    {
+        if(speed > 0.0)
+        {
+            qint64 due = _replayStart + qint64((_replayEntry.receivedAt - _replayOrigin) / speed);
+            if(due > now)
+            {
+                // rounded up, so that the entry is due when the timer fires
+                _replayTimer->start(int((due - now + 999999) / 1000000));
+                break;
+            }
+        }
+        else if(copied >= MaxReplayBatch)
+        {
+            _replayTimer->start(0);
+            break;
+        }
+
+        if(_replayEntry.tag == _replayTag && _replayEntry.size > 0)
+        {
+            const GpsdLogReader::Entry& entry = _replayEntry;
+            bool terminated = entry.data[entry.size-1] == '\n';
+            char* buffer = _framer.prepare(entry.size + 1);
+            memcpy(buffer, entry.data, entry.size);
+            // the last line of a text file may lack its line feed
+            if(!terminated)
+                buffer[entry.size] = '\n';
+            _framer.commit(entry.size + (terminated ? 0 : 1));
+            copied += entry.size;
+        }
+        _replayPending = replayFetch();
+    }
+#ifndef QT_NO_DEBUG
+    if(!_replayPending)
+        qInfo() << "Replay of" << _parameters.file << "finished";
+#endif
+    if(copied > 0)
+        forwardLines(now);
+#endif
+}
+
+bool GpsdMasterDevice::replayFetch()
+{
+#ifdef Q_OS_UNIX
+    if(!_scenario)
+        return _replay->next(&_replayEntry);
+
+    // an epoch per entry, without an end
+    const char* device = "scenario";
+    _scenario->next();
+    _scenarioText.clear();
+    if(_parameters.mode == GpsdSourceParameters::JsonMode)
+    {
+        _scenario->appendTpv(&_scenarioText, device);
+        _scenarioText += "\r\n";
+        _scenario->appendSky(&_scenarioText, device);
+        _scenarioText += "\r\n";
+    }
+    else
+        _scenario->appendNmea(&_scenarioText);
+    _replayEntry.receivedAt = _scenario->elapsed();
+    _replayEntry.tag = 0;
+    _replayEntry.data = _scenarioText.data();
+    _replayEntry.size = int(_scenarioText.size());
+    return true;
+#else
+    return false;
+#endif
+}
+
+void GpsdMasterDevice::lingerTimeout()
+{
+    if(!isIdle())
+        return;
+    gpsdStop();
+    gpsdDisconnect();
+}
+
+GpsdSlaveDevice* GpsdMasterDevice::createSlave()
 {
-    if(!_slaves.size() && !gpsdConnect())
+    if(QThread::currentThread() == thread())
+        return createSlaveFor(thread());
+
+    GpsdSlaveDevice* slave = 0;
+    QMetaObject::invokeMethod(this, "createSlaveFor", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(GpsdSlaveDevice*, slave),
+                              Q_ARG(QThread*, QThread::currentThread()));
+    return slave;
+}
+
+GpsdSlaveDevice* GpsdMasterDevice::createSlaveFor(QThread* thread)
+{
+    if(!gpsdConnect())
         return 0;
-    QBuffer* slave = new QBuffer(this);
-    slave->open(QIODevice::ReadWrite);
+    GpsdSlaveDevice* slave = new GpsdSlaveDevice;
+    slave->open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    slave->moveToThread(thread);
     _slaves.append(qMakePair(slave,false));
 #ifndef QT_NO_DEBUG
     qInfo() << "Created slave" << slave;
 #endif
+    if(isIdle())
+        _lingerTimer->start();
     return slave;
 }
 
 void GpsdMasterDevice::destroySlave(QIODevice* slave)
+{
+    if(QThread::currentThread() == thread())
+        removeSlave(slave);
+    else
+        QMetaObject::invokeMethod(this, "removeSlave", Qt::BlockingQueuedConnection,
+                                  Q_ARG(QIODevice*, slave));
+
+    // the slave lives in the caller's thread and is no longer fed
+#ifndef QT_NO_DEBUG
+    qInfo() << "Destroyed slave" << slave;
+#endif
+    delete slave;
+}
+
+void GpsdMasterDevice::removeSlave(QIODevice* slave)
 {
     SlaveListT::iterator it = _slaves.begin();
     for(; it!=_slaves.end(); ++it)
@@ -174,23 +738,23 @@ void GpsdMasterDevice::destroySlave(QIODevice* slave)
         if(it->first == slave)
         {
             _slaves.erase(it);
-#ifndef QT_NO_DEBUG
-            qInfo() << "Destroyed slave" << slave;
-#endif
-            delete slave;
             break;
         }
     }
-    if(!_slaves.size())
-    {
-        gpsdStop();
-        gpsdDisconnect();
-    }
+    // keep the connection around for a while, the slave might be replaced
+    if(isIdle())
+        _lingerTimer->start();
 }
 
 void GpsdMasterDevice::pauseSlave(QIODevice* slave)
 {
-    bool allPaused = true;
+    if(QThread::currentThread() != thread())
+    {
+        QMetaObject::invokeMethod(this, "pauseSlave", Qt::BlockingQueuedConnection,
+                                  Q_ARG(QIODevice*, slave));
+        return;
+    }
+
     SlaveListT::iterator it = _slaves.begin();
     for(; it!=_slaves.end(); ++it)
     {
@@ -200,16 +764,25 @@ void GpsdMasterDevice::pauseSlave(QIODevice* slave)
             qInfo() << "Pausing slave" << slave;
 #endif
             it->second = false;
+            break;
         }
-        if(it->second)
-            allPaused = false;
     }
-    if(allPaused)
-        gpsdStop();
+    // gpsd keeps streaming until the linger timeout, so that a quick
+    // unpause neither reconnects nor has to wait for fresh data
+    if(isIdle())
+        _lingerTimer->start();
 }
 
-void GpsdMasterDevice::unpauseSlave(QIODevice* slave)
+bool GpsdMasterDevice::unpauseSlave(QIODevice* slave)
 {
+    if(QThread::currentThread() != thread())
+    {
+        bool ok = false;
+        QMetaObject::invokeMethod(this, "unpauseSlave", Qt::BlockingQueuedConnection,
+                                  Q_RETURN_ARG(bool, ok), Q_ARG(QIODevice*, slave));
+        return ok;
+    }
+
     SlaveListT::iterator it = _slaves.begin();
     for(; it!=_slaves.end(); ++it)
     {
@@ -218,9 +791,12 @@ void GpsdMasterDevice::unpauseSlave(QIODevice* slave)
 #ifndef QT_NO_DEBUG
             qInfo() << "Unpausing slave" << slave;
 #endif
+            _lingerTimer->stop();
+            if(!gpsdConnect())
+                return false;
             it->second = true;
-            gpsdStart();
-            break;
+            return gpsdStart();
         }
     }
+    return false;
 }
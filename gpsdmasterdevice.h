@@ -26,45 +26,155 @@
 #ifndef GPSDMASTERDEVICE_H
 #define GPSDMASTERDEVICE_H
 
+#include "gpsdlineframer.h"
+#include "gpsdlogreader.h"
+#include "gpsdsatellitesnapshot.h"
+#include "gpsdsourceparameters.h"
+
 #include <QObject>
+#include <QGeoPositionInfo>
+#include <QHash>
 #include <QList>
+#include <QMutex>
 #include <QPair>
 
+#include <string>
+
+class GpsdRecorder;
+class GpsdScenario;
+class GpsdSlaveDevice;
 class QIODevice;
 class QTcpSocket;
+class QThread;
+class QTimer;
 
+// One connection to gpsd, shared by all sources reading the same receiver
+// of the same gpsd instance in the same mode. Masters are reference
+// counted: acquire() returns the master of the connection described by the
+// parameters, creating it if needed, and release() destroys it once its
+// last user has gone.
+//
+// With the "replay" transport, the master plays back a recorded log
+// instead of connecting to gpsd, keeping the timing of the recording, or
+// the epochs of a synthetic GpsdScenario.
+//
+// The master lives in the application's main thread. Sources may live in
+// any thread: slave management is carried out in the master's thread,
+// blocking the caller, and each slave lives in the thread of the source
+// that created it, which receives its data through a queued readyRead().
+// Hence a worker thread creating, starting, stopping or destroying a
+// source waits for the main thread's event loop, which must not be
+// waiting for that worker in turn, e.g. in QThread::wait(); and the
+// connect to gpsd blocks the main thread for up to the timeout.
 class GpsdMasterDevice : public QObject
 {
     Q_OBJECT
 
 public:
-    static GpsdMasterDevice* instance();
+    static GpsdMasterDevice* acquire(const GpsdSourceParameters& parameters);
+    static void release(GpsdMasterDevice* master);
+
+    const GpsdSourceParameters& parameters() const;
 
-    QIODevice* createSlave();
+    // CLOCK_MONOTONIC in ns, the time base of all receive timestamps
+    static qint64 monotonicNsecs();
+
+    GpsdSlaveDevice* createSlave();
     void destroySlave(QIODevice* slave);
-    void pauseSlave(QIODevice* slave);
-    void unpauseSlave(QIODevice* slave);
+    Q_INVOKABLE void pauseSlave(QIODevice* slave);
+    Q_INVOKABLE bool unpauseSlave(QIODevice* slave);
+
+    // Most recent NMEA sentences of the given type (e.g. "GSV") that were
+    // received at most maxAge ms ago, of every talker, and for GSA and GSV
+    // of every system and signal; empty if there are none that fresh.
+    // receivedAt is set to the receive time of the oldest of them.
+    QList<QByteArray> recentSentences(const char* type, int maxAge,
+                                      qint64* receivedAt = 0) const;
+    int cacheMaxAge() const;
+
+    // Latest decoded fix and sky view published by any source of this
+    // master, along with the time their data was received. With
+    // maxAge >= 0, they are only returned if at most maxAge ms old.
+    void setLastKnownPosition(const QGeoPositionInfo& info, qint64 receivedAt);
+    QGeoPositionInfo lastKnownPosition(int maxAge = -1, qint64* receivedAt = 0) const;
+    void setLastSatelliteSnapshot(const GpsdSatelliteSnapshot& snapshot, qint64 receivedAt);
+    GpsdSatelliteSnapshot lastSatelliteSnapshot(int maxAge = -1, qint64* receivedAt = 0) const;
 
 private slots:
     void readFromSocketAndCopy();
+    void lingerTimeout();
+    void replayNext();
 
 private:
-    GpsdMasterDevice();
+    explicit GpsdMasterDevice(const GpsdSourceParameters& parameters);
+    ~GpsdMasterDevice();
+    Q_INVOKABLE GpsdSlaveDevice* createSlaveFor(QThread* thread);
+    Q_INVOKABLE void removeSlave(QIODevice* slave);
+    void forwardLines(qint64 receivedAt);
+    bool isConnected() const;
     bool gpsdConnect();
     void gpsdDisconnect();
     bool gpsdStart();
     bool gpsdStop();
+    bool isIdle() const;
+    bool replayOpen();
+    void replayStart();
+    bool replayFetch();
+    void cacheSentence(const char* data, int size, qint64 receivedAt);
+    QByteArray sharedChunk(const char* data, int size);
+
+    typedef QList<QPair<GpsdSlaveDevice*,bool> > SlaveListT;
+    typedef QHash<QString,GpsdMasterDevice*> MasterHashT;
 
-    typedef QList<QPair<QIODevice*,bool> > SlaveListT;
+    struct CachedSentencesT
+    {
+        qint64 received;
+        // the first count sentences are current, the others are kept for
+        // their capacity
+        QList<QByteArray> sentences;
+        int count;
+    };
+    typedef QHash<QByteArray,CachedSentencesT> SentenceCacheT;
 
     SlaveListT _slaves;
     QTcpSocket* _socket;
-    QString _hostname;
-    quint16 _port;
+    GpsdSourceParameters _parameters;
+    QString _key;
+    int _refCount;
     bool _gpsdStarted;
-    int _timeout;
+    bool _wasConnected;
+    QTimer* _lingerTimer;
+
+    // guards the caches, which are read from the sources' threads
+    mutable QMutex _cacheMutex;
+    SentenceCacheT _sentenceCache;
+    int _cacheMaxAge;
+    // of the next GSA sentence in a block of them
+    int _gsaPosition;
+    QGeoPositionInfo _lastPosition;
+    qint64 _lastPositionReceived;
+    GpsdSatelliteSnapshot _lastSnapshot;
+    qint64 _lastSnapshotReceived;
+    GpsdLineFramer _framer;
+    // chunks handed to the slaves, reused once all of them have read them
+    QList<QByteArray> _chunkPool;
+    GpsdRecorder* _recorder;
+    quint16 _recordTag;
+
+    // replay of a recorded log, the pending entry is the next one due
+    GpsdLogReader* _replay;
+    QTimer* _replayTimer;
+    GpsdLogReader::Entry _replayEntry;
+    bool _replayPending;
+    quint16 _replayTag;
+    qint64 _replayStart;
+    qint64 _replayOrigin;
+    // replaces the log, its current epoch is the pending entry
+    GpsdScenario* _scenario;
+    std::string _scenarioText;
 
-    static GpsdMasterDevice* _instance;
+    static MasterHashT _masters;
+    static QMutex _mastersMutex;
 };
 
 #endif // GPSDMASTERDEVICE_H
@@ -0,0 +1,246 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdmetrics.h"
+
+#include "gpsdslavedevice.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QtAlgorithms>
+
+QAtomicInt GpsdMetrics::_enabled(qgetenv("GPSD_METRICS").toInt() != 0);
+QAtomicInteger<qint64> GpsdMetrics::_counters[GpsdMetrics::CounterCount];
+QAtomicInteger<qint64> GpsdMetrics::_buckets[GpsdMetrics::HistogramCount][GpsdMetrics::BucketCount];
+QAtomicInteger<qint64> GpsdMetrics::_sums[GpsdMetrics::HistogramCount];
+QAtomicInteger<qint64> GpsdMetrics::_maxima[GpsdMetrics::HistogramCount];
+
+namespace
+{
+
+// values below 8 have a bucket each, larger ones the bucket of their
+// highest bit and the two bits below it
+int bucketOf(quint64 nsecs)
+{
+    if(nsecs < 8)
+        return int(nsecs);
+    int log = 63 - int(qCountLeadingZeroBits(nsecs));
+    return log * 4 + int((nsecs >> (log - 2)) & 3);
+}
+
+// largest value falling into the bucket
+qint64 bucketLimit(int bucket)
+{
+    if(bucket < 8)
+        return bucket;
+    int log = bucket / 4;
+    return (qint64(4 + bucket % 4 + 1) << (log - 2)) - 1;
+}
+
+}
+
+GpsdMetrics::GpsdMetrics()
+{
+}
+
+GpsdMetrics* GpsdMetrics::instance()
+{
+    static GpsdMetrics metrics;
+    return &metrics;
+}
+
+void GpsdMetrics::setEnabled(bool enabled)
+{
+    _enabled.storeRelease(enabled ? 1 : 0);
+}
+
+void GpsdMetrics::record(Histogram histogram, qint64 nsecs)
+{
+    if(nsecs < 0)
+        nsecs = 0;
+    _buckets[histogram][bucketOf(quint64(nsecs))].fetchAndAddRelaxed(1);
+    _sums[histogram].fetchAndAddRelaxed(nsecs);
+    qint64 maximum = _maxima[histogram].loadAcquire();
+    while(nsecs > maximum && !_maxima[histogram].testAndSetRelaxed(maximum, nsecs, maximum))
+        ;
+}
+
+qint64 GpsdMetrics::bytesReceived() const
+{
+    return _counters[BytesReceived].loadAcquire();
+}
+
+qint64 GpsdMetrics::linesReceived() const
+{
+    return _counters[LinesReceived].loadAcquire();
+}
+
+qint64 GpsdMetrics::checksumFailures() const
+{
+    return _counters[ChecksumFailures].loadAcquire();
+}
+
+qint64 GpsdMetrics::parseErrors() const
+{
+    return _counters[ParseErrors].loadAcquire();
+}
+
+qint64 GpsdMetrics::reconnects() const
+{
+    return _counters[Reconnects].loadAcquire();
+}
+
+qint64 GpsdMetrics::epochsEmitted() const
+{
+    return _counters[EpochsEmitted].loadAcquire();
+}
+
+qint64 GpsdMetrics::suppressedEmissions() const
+{
+    return _counters[SuppressedEmissions].loadAcquire();
+}
+
+qint64 GpsdMetrics::droppedBytes() const
+{
+    return _counters[DroppedBytes].loadAcquire();
+}
+
+qint64 GpsdMetrics::backlog() const
+{
+    QMutexLocker locker(&_slavesMutex);
+    qint64 total = 0;
+    foreach(GpsdSlaveDevice* slave, _slaves)
+        total += slave->backlog();
+    return total;
+}
+
+QVariantMap GpsdMetrics::parseTime() const
+{
+    return histogram(ParseTime);
+}
+
+QVariantMap GpsdMetrics::deliveryLatency() const
+{
+    return histogram(DeliveryLatency);
+}
+
+QVariantMap GpsdMetrics::histogram(Histogram histogram) const
+{
+    qint64 counts[BucketCount];
+    qint64 count = 0;
+    for(int i=0; i<BucketCount; ++i)
+    {
+        counts[i] = _buckets[histogram][i].loadAcquire();
+        count += counts[i];
+    }
+    qint64 maximum = _maxima[histogram].loadAcquire();
+
+    // the limit of the bucket holding the percentile, at most the maximum
+    qint64 percentiles[2] = { 0, 0 };
+    const double fractions[2] = { 0.5, 0.99 };
+    for(int p=0; p<2 && count > 0; ++p)
+    {
+        qint64 rank = qint64(fractions[p] * count + 0.5);
+        qint64 seen = 0;
+        for(int i=0; i<BucketCount; ++i)
+        {
+            seen += counts[i];
+            if(seen >= qMax(rank, qint64(1)))
+            {
+                percentiles[p] = qMin(bucketLimit(i), maximum);
+                break;
+            }
+        }
+    }
+
+    QVariantMap result;
+    result["count"] = count;
+    result["mean"] = count > 0 ? _sums[histogram].loadAcquire() / count : 0;
+    result["p50"] = percentiles[0];
+    result["p99"] = percentiles[1];
+    result["max"] = maximum;
+    return result;
+}
+
+QByteArray GpsdMetrics::dump() const
+{
+    QJsonObject counters;
+    counters["bytes_received"] = bytesReceived();
+    counters["lines_received"] = linesReceived();
+    counters["checksum_failures"] = checksumFailures();
+    counters["parse_errors"] = parseErrors();
+    counters["reconnects"] = reconnects();
+    counters["epochs_emitted"] = epochsEmitted();
+    counters["suppressed_emissions"] = suppressedEmissions();
+    counters["dropped_bytes"] = droppedBytes();
+
+    QJsonArray slaves;
+    {
+        QMutexLocker locker(&_slavesMutex);
+        foreach(GpsdSlaveDevice* slave, _slaves)
+        {
+            QJsonObject object;
+            object["backlog"] = slave->backlog();
+            object["max_backlog"] = slave->maxBacklog();
+            object["dropped_bytes"] = slave->droppedBytes();
+            slaves.append(object);
+        }
+    }
+
+    QJsonObject root;
+    root["enabled"] = isEnabled();
+    root["counters"] = counters;
+    root["parse_time"] = QJsonObject::fromVariantMap(parseTime());
+    root["delivery_latency"] = QJsonObject::fromVariantMap(deliveryLatency());
+    root["sources"] = slaves;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+void GpsdMetrics::reset()
+{
+    for(int i=0; i<CounterCount; ++i)
+        _counters[i].storeRelease(0);
+    for(int h=0; h<HistogramCount; ++h)
+    {
+        for(int i=0; i<BucketCount; ++i)
+            _buckets[h][i].storeRelease(0);
+        _sums[h].storeRelease(0);
+        _maxima[h].storeRelease(0);
+    }
+}
+
+void GpsdMetrics::addSlave(GpsdSlaveDevice* slave)
+{
+    QMutexLocker locker(&_slavesMutex);
+    _slaves.append(slave);
+}
+
+void GpsdMetrics::removeSlave(GpsdSlaveDevice* slave)
+{
+    QMutexLocker locker(&_slavesMutex);
+    _slaves.removeOne(slave);
+}
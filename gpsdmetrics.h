@@ -0,0 +1,158 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDMETRICS_H
+#define GPSDMETRICS_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QVariantMap>
+
+class GpsdSlaveDevice;
+
+// Process-wide counters and histograms of the plugin, for watching it
+// under load. The sources hand out the instance as their metrics
+// property, so applications read it without linking to the plugin:
+//
+//   QObject* metrics = source->property("metrics").value<QObject*>();
+//   metrics->setProperty("enabled", true);
+//   ...
+//   qint64 lines = metrics->property("linesReceived").toLongLong();
+//   QByteArray json;
+//   QMetaObject::invokeMethod(metrics, "dump", Qt::DirectConnection,
+//                             Q_RETURN_ARG(QByteArray, json));
+//
+// Nothing is recorded until recording is enabled, by GPSD_METRICS=1 or the
+// enabled property; until then an instrumented place costs a load of the
+// flag. Enabled, an event costs a relaxed atomic add and a parsed line two
+// clock reads.
+class GpsdMetrics : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled)
+
+    // totals since the start or reset(): bytes and lines of complete lines
+    // read from gpsd, NMEA lines with a wrong checksum, lines with a valid
+    // checksum which a source could not decode, counted per source,
+    // connections to gpsd after the first one of a connection key, epochs
+    // emitted as positions and satellite snapshots, satellite updates held
+    // back, and bytes missed by paused or destroyed sources
+    Q_PROPERTY(qint64 bytesReceived READ bytesReceived)
+    Q_PROPERTY(qint64 linesReceived READ linesReceived)
+    Q_PROPERTY(qint64 checksumFailures READ checksumFailures)
+    Q_PROPERTY(qint64 parseErrors READ parseErrors)
+    Q_PROPERTY(qint64 reconnects READ reconnects)
+    Q_PROPERTY(qint64 epochsEmitted READ epochsEmitted)
+    Q_PROPERTY(qint64 suppressedEmissions READ suppressedEmissions)
+    Q_PROPERTY(qint64 droppedBytes READ droppedBytes)
+
+    // unread bytes of all sources right now; dump() lists them per source
+    Q_PROPERTY(qint64 backlog READ backlog)
+
+    // "count", "mean", "p50", "p99" and "max" in ns of the time a source
+    // spends parsing a line, and from reading the data of an epoch to
+    // emitting it
+    Q_PROPERTY(QVariantMap parseTime READ parseTime)
+    Q_PROPERTY(QVariantMap deliveryLatency READ deliveryLatency)
+
+public:
+    enum Counter
+    {
+        BytesReceived,
+        LinesReceived,
+        ChecksumFailures,
+        ParseErrors,
+        Reconnects,
+        EpochsEmitted,
+        SuppressedEmissions,
+        DroppedBytes,
+        CounterCount
+    };
+
+    enum Histogram
+    {
+        ParseTime,
+        DeliveryLatency,
+        HistogramCount
+    };
+
+    static GpsdMetrics* instance();
+
+    static bool isEnabled()
+    {
+        return _enabled.loadAcquire() != 0;
+    }
+    void setEnabled(bool enabled);
+
+    // only to be called while enabled
+    static void add(Counter counter, qint64 value = 1)
+    {
+        _counters[counter].fetchAndAddRelaxed(value);
+    }
+    static void record(Histogram histogram, qint64 nsecs);
+
+    qint64 bytesReceived() const;
+    qint64 linesReceived() const;
+    qint64 checksumFailures() const;
+    qint64 parseErrors() const;
+    qint64 reconnects() const;
+    qint64 epochsEmitted() const;
+    qint64 suppressedEmissions() const;
+    qint64 droppedBytes() const;
+    qint64 backlog() const;
+    QVariantMap parseTime() const;
+    QVariantMap deliveryLatency() const;
+
+    // Everything above and the backlog, maximum backlog and dropped bytes
+    // of each source, as JSON.
+    Q_INVOKABLE QByteArray dump() const;
+    Q_INVOKABLE void reset();
+
+    void addSlave(GpsdSlaveDevice* slave);
+    void removeSlave(GpsdSlaveDevice* slave);
+
+private:
+    // four buckets per power of two, so that percentiles are off by at
+    // most a quarter
+    static const int BucketCount = 256;
+
+    GpsdMetrics();
+    QVariantMap histogram(Histogram histogram) const;
+
+    static QAtomicInt _enabled;
+    static QAtomicInteger<qint64> _counters[CounterCount];
+    static QAtomicInteger<qint64> _buckets[HistogramCount][BucketCount];
+    static QAtomicInteger<qint64> _sums[HistogramCount];
+    static QAtomicInteger<qint64> _maxima[HistogramCount];
+
+    mutable QMutex _slavesMutex;
+    QList<GpsdSlaveDevice*> _slaves;
+};
+
+#endif // GPSDMETRICS_H
@@ -0,0 +1,151 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdpositionpredictor.h"
+
+#include <QMutexLocker>
+#include <qmath.h>
+#include <qnumeric.h>
+
+namespace
+{
+
+const double EarthRadius = 6371000.0;
+
+}
+
+GpsdPositionPredictor::GpsdPositionPredictor()
+    : _lastReceivedAt(0)
+    , _previousReceivedAt(0)
+    , _speed(0)
+    , _course(0)
+    , _climb(0)
+    , _maxHorizon(2000000000)
+{
+}
+
+void GpsdPositionPredictor::addFix(const QGeoPositionInfo& info, qint64 receivedAt)
+{
+    if(!info.coordinate().isValid())
+        return;
+
+    QMutexLocker locker(&_mutex);
+    _previous = _last;
+    _previousReceivedAt = _lastReceivedAt;
+    _last = info;
+    _lastReceivedAt = receivedAt;
+
+    // elapsed time between the fixes, preferably from the receiver's clock
+    qreal dt = 0;
+    if(_previous.isValid())
+    {
+        if(_previous.timestamp().isValid() && _last.timestamp().isValid())
+            dt = _previous.timestamp().msecsTo(_last.timestamp()) / 1000.0;
+        else
+            dt = (_lastReceivedAt - _previousReceivedAt) / 1e9;
+    }
+
+    const QGeoCoordinate& from = _previous.coordinate();
+    const QGeoCoordinate& to = _last.coordinate();
+
+    if(info.hasAttribute(QGeoPositionInfo::GroundSpeed)
+            && info.hasAttribute(QGeoPositionInfo::Direction))
+    {
+        _speed = info.attribute(QGeoPositionInfo::GroundSpeed);
+        _course = info.attribute(QGeoPositionInfo::Direction);
+    }
+    else if(dt > 0)
+    {
+        _speed = from.distanceTo(to) / dt;
+        _course = from.azimuthTo(to);
+    }
+    else
+        _speed = 0;
+
+    if(info.hasAttribute(QGeoPositionInfo::VerticalSpeed))
+        _climb = info.attribute(QGeoPositionInfo::VerticalSpeed);
+    else if(dt > 0 && from.type() == QGeoCoordinate::Coordinate3D
+            && to.type() == QGeoCoordinate::Coordinate3D)
+        _climb = (to.altitude() - from.altitude()) / dt;
+    else
+        _climb = 0;
+}
+
+void GpsdPositionPredictor::reset()
+{
+    QMutexLocker locker(&_mutex);
+    _last = QGeoPositionInfo();
+    _previous = QGeoPositionInfo();
+    _lastReceivedAt = 0;
+    _previousReceivedAt = 0;
+    _speed = 0;
+    _course = 0;
+    _climb = 0;
+}
+
+int GpsdPositionPredictor::maxHorizon() const
+{
+    QMutexLocker locker(&_mutex);
+    return int(_maxHorizon / 1000000);
+}
+
+void GpsdPositionPredictor::setMaxHorizon(int msec)
+{
+    QMutexLocker locker(&_mutex);
+    _maxHorizon = qint64(qMax(msec, 0)) * 1000000;
+}
+
+QGeoPositionInfo GpsdPositionPredictor::predict(qint64 at) const
+{
+    QMutexLocker locker(&_mutex);
+    if(!_last.isValid())
+        return QGeoPositionInfo();
+
+    qint64 ahead = qBound(qint64(0), at - _lastReceivedAt, _maxHorizon);
+    qreal dt = ahead / 1e9;
+
+    // flat earth around the last fix, good enough for a few seconds
+    QGeoCoordinate coordinate = _last.coordinate();
+    qreal course = qDegreesToRadians(_course);
+    qreal north = _speed * qCos(course) * dt;
+    qreal east = _speed * qSin(course) * dt;
+    double latitude = coordinate.latitude() + qRadiansToDegrees(north / EarthRadius);
+    double longitude = coordinate.longitude()
+            + qRadiansToDegrees(east / (EarthRadius * qCos(qDegreesToRadians(coordinate.latitude()))));
+    if(longitude > 180)
+        longitude -= 360;
+    else if(longitude < -180)
+        longitude += 360;
+    coordinate.setLatitude(qBound(-90.0, latitude, 90.0));
+    coordinate.setLongitude(longitude);
+    if(coordinate.type() == QGeoCoordinate::Coordinate3D)
+        coordinate.setAltitude(coordinate.altitude() + _climb * dt);
+
+    QGeoPositionInfo info = _last;
+    info.setCoordinate(coordinate);
+    if(info.timestamp().isValid())
+        info.setTimestamp(info.timestamp().addMSecs(ahead / 1000000));
+    return info;
+}
@@ -0,0 +1,66 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDPOSITIONPREDICTOR_H
+#define GPSDPOSITIONPREDICTOR_H
+
+#include <QGeoPositionInfo>
+#include <QMutex>
+
+// Extrapolates the last fix to an arbitrary CLOCK_MONOTONIC time using its
+// ground speed, course and vertical speed. Where the receiver does not
+// report them, they are derived from the previous fix.
+//
+// Fixes are added from the source's thread, predictions may be queried
+// from any thread.
+class GpsdPositionPredictor
+{
+public:
+    GpsdPositionPredictor();
+
+    void addFix(const QGeoPositionInfo& info, qint64 receivedAt);
+    void reset();
+
+    // Predictions never reach further than maxHorizon ms past the last fix,
+    // so a lost receiver does not send the position off indefinitely;
+    // 2000 by default.
+    int maxHorizon() const;
+    void setMaxHorizon(int msec);
+
+    QGeoPositionInfo predict(qint64 at) const;
+
+private:
+    mutable QMutex _mutex;
+    QGeoPositionInfo _last;
+    qint64 _lastReceivedAt;
+    QGeoPositionInfo _previous;
+    qint64 _previousReceivedAt;
+    qreal _speed;
+    qreal _course;
+    qreal _climb;
+    qint64 _maxHorizon;
+};
+
+#endif // GPSDPOSITIONPREDICTOR_H
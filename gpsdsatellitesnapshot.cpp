@@ -0,0 +1,160 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdsatellitesnapshot.h"
+
+#include <QSharedData>
+#include <qnumeric.h>
+
+namespace
+{
+
+QVariantList satellitesToVariantList(const QList<QGeoSatelliteInfo>& satellites)
+{
+    QVariantList list;
+    list.reserve(satellites.size());
+    foreach(const QGeoSatelliteInfo& satellite, satellites)
+    {
+        QVariantMap map;
+        map.insert("system", int(satellite.satelliteSystem()));
+        map.insert("prn", satellite.satelliteIdentifier());
+        map.insert("signalStrength", satellite.signalStrength());
+        if(satellite.hasAttribute(QGeoSatelliteInfo::Elevation))
+            map.insert("elevation", satellite.attribute(QGeoSatelliteInfo::Elevation));
+        if(satellite.hasAttribute(QGeoSatelliteInfo::Azimuth))
+            map.insert("azimuth", satellite.attribute(QGeoSatelliteInfo::Azimuth));
+        list.append(map);
+    }
+    return list;
+}
+
+}
+
+class GpsdSatelliteSnapshotPrivate : public QSharedData
+{
+public:
+    GpsdSatelliteSnapshotPrivate()
+        : valid(false)
+        , fixMode(GpsdSatelliteSnapshot::UnknownFix)
+        , pdop(qQNaN())
+        , hdop(qQNaN())
+        , vdop(qQNaN())
+    {}
+
+    bool valid;
+    QList<QGeoSatelliteInfo> satellitesInView;
+    QList<QGeoSatelliteInfo> satellitesInUse;
+    GpsdSatelliteSnapshot::FixMode fixMode;
+    qreal pdop;
+    qreal hdop;
+    qreal vdop;
+};
+
+GpsdSatelliteSnapshot::GpsdSatelliteSnapshot()
+    : d(new GpsdSatelliteSnapshotPrivate)
+{
+}
+
+GpsdSatelliteSnapshot::GpsdSatelliteSnapshot(
+        const QList<QGeoSatelliteInfo>& satellitesInView,
+        const QList<QGeoSatelliteInfo>& satellitesInUse,
+        FixMode fixMode, qreal pdop, qreal hdop, qreal vdop)
+    : d(new GpsdSatelliteSnapshotPrivate)
+{
+    d->valid = true;
+    d->satellitesInView = satellitesInView;
+    d->satellitesInUse = satellitesInUse;
+    d->fixMode = fixMode;
+    d->pdop = pdop;
+    d->hdop = hdop;
+    d->vdop = vdop;
+}
+
+GpsdSatelliteSnapshot::GpsdSatelliteSnapshot(const GpsdSatelliteSnapshot& other)
+    : d(other.d)
+{
+}
+
+GpsdSatelliteSnapshot::~GpsdSatelliteSnapshot()
+{
+}
+
+GpsdSatelliteSnapshot& GpsdSatelliteSnapshot::operator=(const GpsdSatelliteSnapshot& other)
+{
+    d = other.d;
+    return *this;
+}
+
+bool GpsdSatelliteSnapshot::isValid() const
+{
+    return d->valid;
+}
+
+QList<QGeoSatelliteInfo> GpsdSatelliteSnapshot::satellitesInView() const
+{
+    return d->satellitesInView;
+}
+
+QList<QGeoSatelliteInfo> GpsdSatelliteSnapshot::satellitesInUse() const
+{
+    return d->satellitesInUse;
+}
+
+GpsdSatelliteSnapshot::FixMode GpsdSatelliteSnapshot::fixMode() const
+{
+    return d->fixMode;
+}
+
+qreal GpsdSatelliteSnapshot::pdop() const
+{
+    return d->pdop;
+}
+
+qreal GpsdSatelliteSnapshot::hdop() const
+{
+    return d->hdop;
+}
+
+qreal GpsdSatelliteSnapshot::vdop() const
+{
+    return d->vdop;
+}
+
+QVariantMap GpsdSatelliteSnapshot::toVariantMap() const
+{
+    QVariantMap map;
+    if(!d->valid)
+        return map;
+    map.insert("satellitesInView", satellitesToVariantList(d->satellitesInView));
+    map.insert("satellitesInUse", satellitesToVariantList(d->satellitesInUse));
+    map.insert("fixMode", int(d->fixMode));
+    if(!qIsNaN(d->pdop))
+        map.insert("pdop", d->pdop);
+    if(!qIsNaN(d->hdop))
+        map.insert("hdop", d->hdop);
+    if(!qIsNaN(d->vdop))
+        map.insert("vdop", d->vdop);
+    return map;
+}
@@ -0,0 +1,81 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDSATELLITESNAPSHOT_H
+#define GPSDSATELLITESNAPSHOT_H
+
+#include <QGeoSatelliteInfo>
+#include <QList>
+#include <QSharedDataPointer>
+#include <QVariantMap>
+
+class GpsdSatelliteSnapshotPrivate;
+
+// Immutable view of the sky for one receiver epoch, combining the
+// satellites of a complete GSV cycle with the fix status of the GSA
+// sentence belonging to it. Copies are cheap, the data is shared.
+class GpsdSatelliteSnapshot
+{
+public:
+    enum FixMode
+    {
+        UnknownFix = 0,
+        NoFix = 1,
+        Fix2D = 2,
+        Fix3D = 3
+    };
+
+    GpsdSatelliteSnapshot();
+    GpsdSatelliteSnapshot(const QList<QGeoSatelliteInfo>& satellitesInView,
+                          const QList<QGeoSatelliteInfo>& satellitesInUse,
+                          FixMode fixMode, qreal pdop, qreal hdop, qreal vdop);
+    GpsdSatelliteSnapshot(const GpsdSatelliteSnapshot& other);
+    ~GpsdSatelliteSnapshot();
+
+    GpsdSatelliteSnapshot& operator=(const GpsdSatelliteSnapshot& other);
+
+    bool isValid() const;
+
+    QList<QGeoSatelliteInfo> satellitesInView() const;
+    QList<QGeoSatelliteInfo> satellitesInUse() const;
+    FixMode fixMode() const;
+
+    // dilutions of precision, NaN if not reported by the receiver
+    qreal pdop() const;
+    qreal hdop() const;
+    qreal vdop() const;
+
+    // as published by the satellite source's snapshot property: the lists
+    // satellitesInView and satellitesInUse of maps with system, prn,
+    // signalStrength and, if known, elevation and azimuth, and fixMode,
+    // pdop, hdop and vdop; dilutions not reported are left out. Empty if
+    // not valid.
+    QVariantMap toVariantMap() const;
+
+private:
+    QSharedDataPointer<GpsdSatelliteSnapshotPrivate> d;
+};
+
+#endif // GPSDSATELLITESNAPSHOT_H
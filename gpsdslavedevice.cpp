@@ -0,0 +1,209 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdslavedevice.h"
+
+#include "gpsdmetrics.h"
+
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QThread>
+#include <cstring>
+
+GpsdSlaveDevice::GpsdSlaveDevice(QObject* parent)
+    : QIODevice(parent)
+    , _synchronous(false)
+    , _head(0)
+    , _readPos(0)
+    , _available(0)
+    , _maxAvailable(0)
+    , _lastReadTimestamp(0)
+{
+    GpsdMetrics::instance()->addSlave(this);
+}
+
+GpsdSlaveDevice::~GpsdSlaveDevice()
+{
+    GpsdMetrics::instance()->removeSlave(this);
+    if(GpsdMetrics::isEnabled())
+        GpsdMetrics::add(GpsdMetrics::DroppedBytes, _available);
+}
+
+bool GpsdSlaveDevice::isSequential() const
+{
+    return true;
+}
+
+qint64 GpsdSlaveDevice::bytesAvailable() const
+{
+    QMutexLocker locker(&_mutex);
+    return _available + QIODevice::bytesAvailable();
+}
+
+bool GpsdSlaveDevice::canReadLine() const
+{
+    QMutexLocker locker(&_mutex);
+    for(int i=_head; i<_chunks.size(); ++i)
+    {
+        if(_chunks.at(i).data.indexOf('\n', i == _head ? _readPos : 0) >= 0)
+            return true;
+    }
+    return QIODevice::canReadLine();
+}
+
+void GpsdSlaveDevice::appendData(const QByteArray& chunk, qint64 receivedAt)
+{
+    QMutexLocker locker(&_mutex);
+    compact();
+    ChunkT entry;
+    entry.data = chunk;
+    entry.receivedAt = receivedAt;
+    _chunks.append(entry);
+    _available += chunk.size();
+    if(_available > _maxAvailable)
+        _maxAvailable = _available;
+}
+
+qint64 GpsdSlaveDevice::lastReadTimestamp() const
+{
+    QMutexLocker locker(&_mutex);
+    return _lastReadTimestamp;
+}
+
+void GpsdSlaveDevice::notifyReadyRead()
+{
+    if(_synchronous && thread() == QThread::currentThread())
+        emit readyRead();
+    else if(_notifyPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "emitReadyRead", Qt::QueuedConnection);
+}
+
+void GpsdSlaveDevice::setSynchronous(bool synchronous)
+{
+    _synchronous = synchronous;
+}
+
+void GpsdSlaveDevice::reserve(int size)
+{
+    // a read from gpsd carries an epoch of a few hundred bytes
+    QMutexLocker locker(&_mutex);
+    _chunks.reserve(size / 256 + 1);
+}
+
+qint64 GpsdSlaveDevice::backlog() const
+{
+    QMutexLocker locker(&_mutex);
+    return _available;
+}
+
+qint64 GpsdSlaveDevice::maxBacklog() const
+{
+    QMutexLocker locker(&_mutex);
+    return _maxAvailable;
+}
+
+qint64 GpsdSlaveDevice::droppedBytes() const
+{
+    return _dropped.loadAcquire();
+}
+
+void GpsdSlaveDevice::countDropped(qint64 size)
+{
+    _dropped.fetchAndAddRelaxed(size);
+    GpsdMetrics::add(GpsdMetrics::DroppedBytes, size);
+}
+
+void GpsdSlaveDevice::emitReadyRead()
+{
+    // data appended from now on needs another notification
+    _notifyPending.storeRelease(0);
+    emit readyRead();
+}
+
+qint64 GpsdSlaveDevice::readData(char* data, qint64 maxSize)
+{
+    QMutexLocker locker(&_mutex);
+    return take(data, maxSize, false);
+}
+
+qint64 GpsdSlaveDevice::readLineData(char* data, qint64 maxSize)
+{
+    // QIODevice's default implementation reads byte by byte
+    QMutexLocker locker(&_mutex);
+    return take(data, maxSize, true);
+}
+
+qint64 GpsdSlaveDevice::writeData(const char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+qint64 GpsdSlaveDevice::take(char* data, qint64 maxSize, bool line)
+{
+    qint64 copied = 0;
+    while(copied < maxSize && _head < _chunks.size())
+    {
+        ChunkT& chunk = _chunks[_head];
+        const char* start = chunk.data.constData() + _readPos;
+        int size = int(qMin(qint64(chunk.data.size() - _readPos), maxSize - copied));
+        const char* eol = line ? static_cast<const char*>(memchr(start, '\n', size)) : 0;
+        if(eol)
+            size = int(eol - start) + 1;
+        memcpy(data + copied, start, size);
+        copied += size;
+        _readPos += size;
+
+        // the chunk holding the last byte read provides the timestamp
+        _lastReadTimestamp = chunk.receivedAt;
+        if(_readPos == chunk.data.size())
+        {
+            // lets the master reuse the chunk
+            chunk.data = QByteArray();
+            ++_head;
+            _readPos = 0;
+        }
+        if(eol)
+            break;
+    }
+    _available -= copied;
+    return copied;
+}
+
+void GpsdSlaveDevice::compact()
+{
+    // drop read chunks once they make up the larger part of the queue
+    if(_head == _chunks.size())
+    {
+        _chunks.resize(0);
+        _head = 0;
+    }
+    else if(_head > _chunks.size() / 2)
+    {
+        _chunks.remove(0, _head);
+        _head = 0;
+    }
+}
@@ -0,0 +1,111 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDSLAVEDEVICE_H
+#define GPSDSLAVEDEVICE_H
+
+#include <QIODevice>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QMutex>
+#include <QVector>
+
+// Sequential read-only device through which GpsdMasterDevice hands the
+// gpsd stream to a single source. The master appends chunks of complete
+// lines, which all its slaves share instead of copying them, and the
+// source reads them; a chunk is released once it has been read. The
+// master and the source may live in different threads.
+class GpsdSlaveDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit GpsdSlaveDevice(QObject* parent = 0);
+    ~GpsdSlaveDevice();
+
+    bool isSequential() const;
+    qint64 bytesAvailable() const;
+    bool canReadLine() const;
+
+    void appendData(const QByteArray& chunk, qint64 receivedAt);
+
+    // Receive time (GpsdMasterDevice::monotonicNsecs()) of the data
+    // returned by the last read.
+    qint64 lastReadTimestamp() const;
+
+    // Emits readyRead() for the data appended since the last call, right
+    // away if synchronous, otherwise on the next event loop turn. Called
+    // from another thread, it always queues, at most one notification at
+    // a time.
+    void notifyReadyRead();
+    void setSynchronous(bool synchronous);
+
+    // preallocates the queue for about size bytes of unread data
+    void reserve(int size);
+
+    // for GpsdMetrics, safe from any thread: the unread data in the
+    // queue, unlike bytesAvailable() without QIODevice's own buffer, the
+    // most unread data so far, and the bytes missed while paused, counted
+    // by the master
+    qint64 backlog() const;
+    qint64 maxBacklog() const;
+    qint64 droppedBytes() const;
+    void countDropped(qint64 size);
+
+protected:
+    qint64 readData(char* data, qint64 maxSize);
+    qint64 readLineData(char* data, qint64 maxSize);
+    qint64 writeData(const char* data, qint64 maxSize);
+
+private slots:
+    void emitReadyRead();
+
+private:
+    qint64 take(char* data, qint64 maxSize, bool line);
+    void compact();
+
+    struct ChunkT
+    {
+        QByteArray data;
+        qint64 receivedAt;
+    };
+    typedef QVector<ChunkT> ChunkQueueT;
+
+    mutable QMutex _mutex;
+    QAtomicInt _notifyPending;
+    bool _synchronous;
+
+    // chunks before _head have been read, _readPos is in the head chunk
+    ChunkQueueT _chunks;
+    int _head;
+    int _readPos;
+    qint64 _available;
+    qint64 _maxAvailable;
+    qint64 _lastReadTimestamp;
+    QAtomicInteger<qint64> _dropped;
+};
+
+#endif // GPSDSLAVEDEVICE_H
@@ -0,0 +1,136 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdsourceparameters.h"
+
+#include <QDebug>
+
+namespace
+{
+
+QString envString(const char* name, const QString& defaultValue)
+{
+    QByteArray value = qgetenv(name);
+    return value.isEmpty() ? defaultValue : QString::fromLocal8Bit(value);
+}
+
+int envInt(const char* name, int defaultValue)
+{
+    bool ok = false;
+    int value = qgetenv(name).toInt(&ok);
+    return ok ? value : defaultValue;
+}
+
+template<typename T>
+T parameter(const QVariantMap& parameters, const char* name, const T& defaultValue)
+{
+    QVariant value = parameters.value(QLatin1String(name));
+    if(!value.isValid())
+        return defaultValue;
+    if(!value.canConvert<T>() || !value.convert(qMetaTypeId<T>()))
+    {
+        qWarning() << "Ignoring invalid value of" << name << parameters.value(QLatin1String(name));
+        return defaultValue;
+    }
+    return value.value<T>();
+}
+
+}
+
+GpsdSourceParameters::GpsdSourceParameters()
+    : transport("tcp")
+    , hostname(envString("GPSD_HOST", "localhost"))
+    , port(2947)
+    , device(envString("GPSD_DEVICE", QString()))
+    , mode(NmeaMode)
+    , timeout(1000)
+    , highRate(envInt("GPSD_HIGH_RATE", 0) != 0)
+    , bufferSize(4096)
+    , speed(1.0)
+    , start(0)
+    , scenario(false)
+    , seed(1)
+    , rate(1.0)
+    , satellites(12)
+{
+    int envPort = envInt("GPSD_PORT", 0);
+    if(envPort > 0 && envPort <= 0xffff)
+        port = envPort;
+}
+
+GpsdSourceParameters::GpsdSourceParameters(const QVariantMap& parameters)
+    : GpsdSourceParameters()
+{
+    transport = parameter(parameters, "gpsd.transport", transport);
+    hostname = parameter(parameters, "gpsd.host", hostname);
+    int tmpPort = parameter(parameters, "gpsd.port", int(port));
+    if(tmpPort > 0 && tmpPort <= 0xffff)
+        port = tmpPort;
+    device = parameter(parameters, "gpsd.device", device);
+    QString tmpMode = parameter(parameters, "gpsd.mode", QString());
+    if(tmpMode == "json")
+        mode = JsonMode;
+    else if(tmpMode == "nmea")
+        mode = NmeaMode;
+    timeout = parameter(parameters, "gpsd.timeout", timeout);
+    highRate = parameter(parameters, "gpsd.high_rate", highRate);
+    bufferSize = qMax(parameter(parameters, "gpsd.buffer_size", bufferSize), 0);
+    file = parameter(parameters, "gpsd.file", file);
+    // "4", "4x" or "max"
+    QString tmpSpeed = parameter(parameters, "gpsd.speed", QString());
+    if(tmpSpeed == "max")
+    {
+        speed = 0.0;
+    }
+    else if(!tmpSpeed.isEmpty())
+    {
+        bool ok = false;
+        double tmp = tmpSpeed.endsWith('x') ? tmpSpeed.left(tmpSpeed.size()-1).toDouble(&ok)
+                                            : tmpSpeed.toDouble(&ok);
+        if(ok && tmp >= 0.0)
+            speed = tmp;
+        else
+            qWarning() << "Ignoring invalid value of gpsd.speed" << tmpSpeed;
+    }
+    start = qMax(parameter(parameters, "gpsd.start", start), qint64(0));
+    scenario = parameters.contains(QLatin1String("gpsd.scenario"));
+    seed = parameter(parameters, "gpsd.scenario", seed);
+    double tmpRate = parameter(parameters, "gpsd.rate", rate);
+    if(tmpRate > 0.0)
+        rate = tmpRate;
+    satellites = qMax(parameter(parameters, "gpsd.satellites", satellites), 0);
+}
+
+QString GpsdSourceParameters::connectionKey() const
+{
+    if(transport == "replay" && scenario)
+        return QString("scenario://%1?%2&%3&%4&%5&%6").arg(seed).arg(rate).arg(satellites)
+                .arg(speed).arg(start).arg(mode == JsonMode ? "json" : "nmea");
+    if(transport == "replay")
+        return QString("replay://%1?%2&%3&%4").arg(file).arg(speed).arg(start)
+                .arg(mode == JsonMode ? "json" : "nmea");
+    return QString("%1://%2:%3/%4?%5").arg(transport).arg(hostname).arg(port)
+            .arg(device).arg(mode == JsonMode ? "json" : "nmea");
+}
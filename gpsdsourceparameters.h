@@ -0,0 +1,82 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GPSDSOURCEPARAMETERS_H
+#define GPSDSOURCEPARAMETERS_H
+
+#include <QString>
+#include <QVariantMap>
+
+// Configuration of a source, taken from the parameters passed to
+// QGeoPositionInfoSource::createSource() with the environment variables
+// as defaults:
+//
+//   gpsd.transport    "tcp", or "replay" to play back a recorded log
+//   gpsd.host         GPSD_HOST or "localhost"
+//   gpsd.port         GPSD_PORT or 2947
+//   gpsd.device       GPSD_DEVICE, empty for all receivers
+//   gpsd.mode         "nmea" or "json"
+//   gpsd.timeout      connect timeout in ms, 1000
+//   gpsd.high_rate    synchronous delivery, GPSD_HIGH_RATE or false
+//   gpsd.buffer_size  initial receive buffer of the source in bytes, 4096
+//   gpsd.file         log to replay
+//   gpsd.speed        replay speed, 1 for real time, "max" or 0 for maximum
+//   gpsd.start        ms into the log at which the replay starts, 0
+//   gpsd.scenario     seed of a synthetic GpsdScenario to replay instead of
+//                     a log
+//   gpsd.rate         scenario epochs per second, 1
+//   gpsd.satellites   scenario satellites in view, 12
+struct GpsdSourceParameters
+{
+    enum Mode
+    {
+        NmeaMode,
+        JsonMode
+    };
+
+    GpsdSourceParameters();
+    explicit GpsdSourceParameters(const QVariantMap& parameters);
+
+    // sources whose keys are equal share one connection
+    QString connectionKey() const;
+
+    QString transport;
+    QString hostname;
+    quint16 port;
+    QString device;
+    Mode mode;
+    int timeout;
+    bool highRate;
+    int bufferSize;
+    QString file;
+    double speed;
+    qint64 start;
+    bool scenario;
+    quint32 seed;
+    double rate;
+    int satellites;
+};
+
+#endif // GPSDSOURCEPARAMETERS_H
@@ -25,35 +25,202 @@
 
 #include "qgeopositioninfosource_gpsd.h"
 
+#include "gpsdjson.h"
 #include "gpsdmasterdevice.h"
+#include "gpsdmetrics.h"
+#include "gpsdslavedevice.h"
 
 #include <QDebug>
+#include <QTimer>
+#include <qnumeric.h>
 
-QGeoPositionInfoSourceGpsd::QGeoPositionInfoSourceGpsd(QObject *parent)
+namespace
+{
+
+void setAttribute(QGeoPositionInfo* info, QGeoPositionInfo::Attribute attribute, double value)
+{
+    if(!qIsNaN(value))
+        info->setAttribute(attribute, value);
+}
+
+QGeoPositionInfo toPositionInfo(const GpsdFix& fix)
+{
+    QGeoCoordinate coordinate(fix.latitude, fix.longitude);
+    if(fix.hasAltitude())
+        coordinate.setAltitude(fix.altitude);
+
+    // GGA and GLL only epochs carry no date
+    QDate date = fix.hasDate() ? QDate(fix.year, fix.month, fix.day) : QDate();
+    QTime time = fix.hasTime() ? QTime::fromMSecsSinceStartOfDay(fix.timeOfDay) : QTime();
+    QGeoPositionInfo info(coordinate, QDateTime(date, time, Qt::UTC));
+
+    setAttribute(&info, QGeoPositionInfo::Direction, fix.course);
+    setAttribute(&info, QGeoPositionInfo::GroundSpeed, fix.speed);
+    setAttribute(&info, QGeoPositionInfo::VerticalSpeed, fix.climb);
+    setAttribute(&info, QGeoPositionInfo::MagneticVariation, fix.magneticVariation);
+    setAttribute(&info, QGeoPositionInfo::HorizontalAccuracy, fix.horizontalAccuracy);
+    setAttribute(&info, QGeoPositionInfo::VerticalAccuracy, fix.verticalAccuracy);
+    return info;
+}
+
+}
+
+QGeoPositionInfoSourceGpsd::QGeoPositionInfoSourceGpsd(const GpsdSourceParameters& parameters,
+                                                       QObject *parent)
     : QNmeaPositionInfoSource(QNmeaPositionInfoSource::RealTimeMode, parent)
+    , _parameters(parameters)
+    , _master(GpsdMasterDevice::acquire(parameters))
     , _device(0)
+    , _lastError(QGeoPositionInfoSource::NoError)
     , _running(false)
+    , _requesting(false)
+    , _replyingFromCache(false)
+    , _cachedReceivedAt(0)
+    , _parsedReceivedAt(0)
+    , _lastUpdateReceivedAt(0)
+    , _predictionEnabled(false)
+    , _filterEnabled(false)
 {
     qDebug() << "QGeoPositionInfoSourceGpsd";
-    _device = GpsdMasterDevice::instance()->createSlave();
-    setDevice(_device);
+    connect(this, SIGNAL(positionUpdated(QGeoPositionInfo)), this, SLOT(publishPosition(QGeoPositionInfo)));
+    connect(this, SIGNAL(positionUpdated(QGeoPositionInfo)), this, SLOT(requestFinished()));
+    connect(this, SIGNAL(updateTimeout()), this, SLOT(requestFinished()));
 }
 
 QGeoPositionInfoSourceGpsd::~QGeoPositionInfoSourceGpsd()
 {
     if(_running)
         stopUpdates();
-    GpsdMasterDevice::instance()->destroySlave(_device);
+    if(_device)
+        _master->destroySlave(_device);
     _device = 0;
+    GpsdMasterDevice::release(_master);
+}
+
+QGeoPositionInfoSource::Error QGeoPositionInfoSourceGpsd::error() const
+{
+    if(_lastError != QGeoPositionInfoSource::NoError)
+        return _lastError;
+    return QNmeaPositionInfoSource::error();
+}
+
+QGeoPositionInfo QGeoPositionInfoSourceGpsd::lastKnownPosition(bool fromSatellitePositioningMethodsOnly) const
+{
+    // another source of this process may have seen a more recent fix
+    QGeoPositionInfo own = QNmeaPositionInfoSource::lastKnownPosition(fromSatellitePositioningMethodsOnly);
+    QGeoPositionInfo shared = _master->lastKnownPosition();
+    if(!shared.isValid() || (own.isValid() && own.timestamp() >= shared.timestamp()))
+        return own;
+    return shared;
+}
+
+qint64 QGeoPositionInfoSourceGpsd::lastUpdateReceivedAt() const
+{
+    return _lastUpdateReceivedAt;
+}
+
+bool QGeoPositionInfoSourceGpsd::predictionEnabled() const
+{
+    return _predictionEnabled;
+}
+
+void QGeoPositionInfoSourceGpsd::setPredictionEnabled(bool enabled)
+{
+    _predictionEnabled = enabled;
+    if(!enabled)
+        _predictor.reset();
+}
+
+int QGeoPositionInfoSourceGpsd::predictionHorizon() const
+{
+    return _predictor.maxHorizon();
+}
+
+void QGeoPositionInfoSourceGpsd::setPredictionHorizon(int msec)
+{
+    _predictor.setMaxHorizon(msec);
+}
+
+QGeoPositionInfo QGeoPositionInfoSourceGpsd::predictedPosition(qint64 at) const
+{
+    return _predictor.predict(at);
+}
+
+bool QGeoPositionInfoSourceGpsd::filterEnabled() const
+{
+    return _filterEnabled;
+}
+
+void QGeoPositionInfoSourceGpsd::setFilterEnabled(bool enabled)
+{
+    _filterEnabled = enabled;
+    _filter.reset();
+}
+
+qreal QGeoPositionInfoSourceGpsd::filterProcessNoise() const
+{
+    return _filter.processNoise();
+}
+
+void QGeoPositionInfoSourceGpsd::setFilterProcessNoise(qreal processNoise)
+{
+    _filter.setProcessNoise(processNoise);
+}
+
+QObject* QGeoPositionInfoSourceGpsd::metrics() const
+{
+    return GpsdMetrics::instance();
+}
+
+bool QGeoPositionInfoSourceGpsd::ensureDevice()
+{
+    // connecting to gpsd is deferred until the source is actually used
+    if(!_device)
+    {
+        _device = _master->createSlave();
+        if(!_device)
+        {
+            _lastError = QGeoPositionInfoSource::AccessError;
+            emit QGeoPositionInfoSource::error(_lastError);
+            return false;
+        }
+        _device->setSynchronous(_parameters.highRate);
+        _device->reserve(_parameters.bufferSize);
+        setDevice(_device);
+    }
+    return true;
+}
+
+bool QGeoPositionInfoSourceGpsd::unpauseDevice()
+{
+    if(!_master->unpauseSlave(_device))
+    {
+        _lastError = QGeoPositionInfoSource::AccessError;
+        emit QGeoPositionInfoSource::error(_lastError);
+        return false;
+    }
+    return true;
 }
 
 void QGeoPositionInfoSourceGpsd::startUpdates()
 {
     if(!_running)
     {
-        GpsdMasterDevice::instance()->unpauseSlave(_device);
+        if(!ensureDevice())
+            return;
+        if(!_requesting && !unpauseDevice())
+            return;
+        if(!_requesting)
+        {
+            _assembler.reset();
+            _filter.reset();
+        }
         QNmeaPositionInfoSource::startUpdates();
         _running = true;
+
+        // start off with the fix another source has just seen
+        if(positionFromCache(&_cachedPosition, &_cachedReceivedAt))
+            QTimer::singleShot(0, this, SLOT(replyFromCache()));
     }
 }
 
@@ -62,7 +229,166 @@ void QGeoPositionInfoSourceGpsd::stopUpdates()
     if(_running)
     {
         QNmeaPositionInfoSource::stopUpdates();
-        GpsdMasterDevice::instance()->pauseSlave(_device);
+        if(!_requesting)
+            _master->pauseSlave(_device);
         _running = false;
     }
 }
+
+void QGeoPositionInfoSourceGpsd::requestUpdate(int timeout)
+{
+    if(!_running && positionFromCache(&_cachedPosition, &_cachedReceivedAt))
+    {
+        QTimer::singleShot(0, this, SLOT(replyFromCache()));
+        return;
+    }
+    if(!ensureDevice())
+        return;
+    if(!_running && !_requesting)
+    {
+        if(!unpauseDevice())
+            return;
+        _assembler.reset();
+        _filter.reset();
+        _requesting = true;
+    }
+    QNmeaPositionInfoSource::requestUpdate(timeout);
+}
+
+void QGeoPositionInfoSourceGpsd::requestFinished()
+{
+    // the slave was only unpaused for a single update
+    if(_requesting)
+    {
+        _requesting = false;
+        if(!_running)
+            _master->pauseSlave(_device);
+    }
+}
+
+void QGeoPositionInfoSourceGpsd::replyFromCache()
+{
+    if(_cachedPosition.isValid())
+    {
+        QGeoPositionInfo info = _cachedPosition;
+        _cachedPosition = QGeoPositionInfo();
+        _replyingFromCache = true;
+        emit positionUpdated(info);
+        _replyingFromCache = false;
+    }
+}
+
+void QGeoPositionInfoSourceGpsd::publishPosition(const QGeoPositionInfo& info)
+{
+    // connected before any consumer, so lastUpdateReceivedAt already
+    // belongs to this update when consumers see it
+    if(_replyingFromCache)
+        _lastUpdateReceivedAt = _cachedReceivedAt;
+    else
+    {
+        _lastUpdateReceivedAt = _parsedReceivedAt;
+        // the filter is this source's own, other sources of the master get
+        // the fix as received
+        if(_unfilteredPosition.isValid())
+        {
+            QGeoPositionInfo unfiltered = _unfilteredPosition;
+            unfiltered.setTimestamp(info.timestamp());
+            _master->setLastKnownPosition(unfiltered, _lastUpdateReceivedAt);
+        }
+        else
+            _master->setLastKnownPosition(info, _lastUpdateReceivedAt);
+        if(GpsdMetrics::isEnabled())
+        {
+            GpsdMetrics::add(GpsdMetrics::EpochsEmitted);
+            GpsdMetrics::record(GpsdMetrics::DeliveryLatency,
+                                GpsdMasterDevice::monotonicNsecs() - _lastUpdateReceivedAt);
+        }
+    }
+    if(_predictionEnabled)
+        _predictor.addFix(info, _lastUpdateReceivedAt);
+}
+
+bool QGeoPositionInfoSourceGpsd::positionFromCache(QGeoPositionInfo* info, qint64* receivedAt)
+{
+    int maxAge = _master->cacheMaxAge();
+    if(maxAge <= 0)
+        return false;
+
+    QGeoPositionInfo shared = _master->lastKnownPosition(maxAge, receivedAt);
+    if(shared.isValid())
+    {
+        *info = shared;
+        return true;
+    }
+
+    // the epoch is dated by its RMC sentence, or GGA without one
+    QList<QByteArray> sentences = _master->recentSentences("RMC", maxAge, receivedAt);
+    sentences += _master->recentSentences("GGA", maxAge, sentences.isEmpty() ? receivedAt : 0);
+    sentences += _master->recentSentences("VTG", maxAge);
+    sentences += _master->recentSentences("GST", maxAge);
+
+    GpsdEpochAssembler assembler;
+    GpsdFix epoch;
+    foreach(const QByteArray& sentence, sentences)
+        assembler.addSentence(sentence.constData(), sentence.size(), *receivedAt, &epoch);
+    if(!assembler.flush(&epoch) && !epoch.hasFix)
+        return false;
+    *info = toPositionInfo(epoch);
+
+    if(!info->timestamp().date().isValid())
+        info->setTimestamp(QDateTime(QDateTime::currentDateTimeUtc().date(),
+                                     info->timestamp().time(), Qt::UTC));
+    return info->isValid();
+}
+
+bool QGeoPositionInfoSourceGpsd::parsePosInfoFromNmeaData(const char* data, int size,
+                                                          QGeoPositionInfo* posInfo, bool* hasFix)
+{
+    if(!GpsdMetrics::isEnabled())
+        return parsePosition(data, size, posInfo, hasFix);
+
+    qint64 start = GpsdMasterDevice::monotonicNsecs();
+    bool parsed = parsePosition(data, size, posInfo, hasFix);
+    GpsdMetrics::record(GpsdMetrics::ParseTime, GpsdMasterDevice::monotonicNsecs() - start);
+    return parsed;
+}
+
+bool QGeoPositionInfoSourceGpsd::parsePosition(const char* data, int size,
+                                               QGeoPositionInfo* posInfo, bool* hasFix)
+{
+    GpsdFix epoch;
+    if(_parameters.mode == GpsdSourceParameters::JsonMode)
+    {
+        // gpsd has merged the epoch into a TPV report already
+        if(!GpsdJson::decodeTPV(data, size, &epoch))
+        {
+            if(GpsdMetrics::isEnabled() && GpsdJson::isClass(data, size, "TPV"))
+                GpsdMetrics::add(GpsdMetrics::ParseErrors);
+            return false;
+        }
+        if(!epoch.hasPosition())
+            return false;
+        _parsedReceivedAt = _device->lastReadTimestamp();
+    }
+    else
+    {
+        // sentences of one epoch are merged and reported once, as soon as
+        // the epoch is complete
+        if(!_assembler.addSentence(data, size, _device->lastReadTimestamp(), &epoch))
+        {
+            if(_assembler.rejected() && GpsdMetrics::isEnabled())
+                GpsdMetrics::add(GpsdMetrics::ParseErrors);
+            return false;
+        }
+        _parsedReceivedAt = _assembler.completedReceivedAt();
+    }
+    *posInfo = toPositionInfo(epoch);
+    *hasFix = epoch.hasFix;
+    _unfilteredPosition = QGeoPositionInfo();
+    if(_filterEnabled && *hasFix)
+    {
+        _unfilteredPosition = *posInfo;
+        *posInfo = _filter.filter(*posInfo, _parsedReceivedAt);
+    }
+    return true;
+}
@@ -26,23 +26,100 @@
 #ifndef QGEOPOSITIONINFOSOURCE_GPSD_H
 #define QGEOPOSITIONINFOSOURCE_GPSD_H
 
+#include "gpsdepochassembler.h"
+#include "gpsdkalmanfilter.h"
+#include "gpsdpositionpredictor.h"
+#include "gpsdsourceparameters.h"
+
 #include <QNmeaPositionInfoSource>
 
+class GpsdMasterDevice;
+class GpsdSlaveDevice;
+
 class QGeoPositionInfoSourceGpsd : public QNmeaPositionInfoSource
 {
     Q_OBJECT
 
+    // CLOCK_MONOTONIC time in ns at which the data of the last update was
+    // read from the gpsd socket, valid while positionUpdated() is handled
+    Q_PROPERTY(qint64 lastUpdateReceivedAt READ lastUpdateReceivedAt)
+
+    // extrapolation of the last fixes to render time, off by default, at
+    // most predictionHorizon ms past the last fix (default 2000)
+    Q_PROPERTY(bool predictionEnabled READ predictionEnabled WRITE setPredictionEnabled)
+    Q_PROPERTY(int predictionHorizon READ predictionHorizon WRITE setPredictionHorizon)
+
+    // Kalman filtering of position and velocity before emission, off by
+    // default; the process noise is the acceleration noise in m^2/s^3
+    Q_PROPERTY(bool filterEnabled READ filterEnabled WRITE setFilterEnabled)
+    Q_PROPERTY(qreal filterProcessNoise READ filterProcessNoise WRITE setFilterProcessNoise)
+
+    // the process-wide GpsdMetrics, see gpsdmetrics.h
+    Q_PROPERTY(QObject* metrics READ metrics CONSTANT)
+
 public:
-    explicit QGeoPositionInfoSourceGpsd(QObject* parent = 0);
+    explicit QGeoPositionInfoSourceGpsd(const GpsdSourceParameters& parameters,
+                                        QObject* parent = 0);
     ~QGeoPositionInfoSourceGpsd();
 
+    Error error() const;
+    QGeoPositionInfo lastKnownPosition(bool fromSatellitePositioningMethodsOnly = false) const;
+    qint64 lastUpdateReceivedAt() const;
+
+    bool predictionEnabled() const;
+    void setPredictionEnabled(bool enabled);
+    int predictionHorizon() const;
+    void setPredictionHorizon(int msec);
+
+    // Position extrapolated to the given CLOCK_MONOTONIC time in ns. May be
+    // called from any thread; invalid unless prediction is enabled.
+    Q_INVOKABLE QGeoPositionInfo predictedPosition(qint64 at) const;
+
+    bool filterEnabled() const;
+    void setFilterEnabled(bool enabled);
+    qreal filterProcessNoise() const;
+    void setFilterProcessNoise(qreal processNoise);
+
+    QObject* metrics() const;
+
 public slots:
     void startUpdates();
     void stopUpdates();
+    void requestUpdate(int timeout = 0);
+
+protected:
+    bool parsePosInfoFromNmeaData(const char* data, int size,
+                                  QGeoPositionInfo* posInfo, bool* hasFix);
+
+private slots:
+    void replyFromCache();
+    void requestFinished();
+    void publishPosition(const QGeoPositionInfo& info);
 
 private:
-    QIODevice* _device;
+    bool ensureDevice();
+    bool unpauseDevice();
+    bool positionFromCache(QGeoPositionInfo* info, qint64* receivedAt);
+    bool parsePosition(const char* data, int size, QGeoPositionInfo* posInfo, bool* hasFix);
+
+    GpsdSourceParameters _parameters;
+    GpsdMasterDevice* _master;
+    GpsdSlaveDevice* _device;
+    Error _lastError;
     bool _running;
+    bool _requesting;
+    bool _replyingFromCache;
+    QGeoPositionInfo _cachedPosition;
+    qint64 _cachedReceivedAt;
+    GpsdEpochAssembler _assembler;
+    qint64 _parsedReceivedAt;
+    qint64 _lastUpdateReceivedAt;
+    bool _predictionEnabled;
+    GpsdPositionPredictor _predictor;
+    bool _filterEnabled;
+    GpsdKalmanFilter _filter;
+    // the last parsed fix before filtering, invalid if it was not filtered
+    QGeoPositionInfo _unfilteredPosition;
 };
 
 #endif // QGEOPOSITIONINFOSOURCE_GPSD_H
@@ -25,17 +25,18 @@
 
 #include "qgeopositioninfosourcefactory_gpsd.h"
 
+#include "gpsdsourceparameters.h"
 #include "qgeopositioninfosource_gpsd.h"
 #include "qgeosatelliteinfosource_gpsd.h"
 
 QGeoPositionInfoSource *QGeoPositionInfoSourceFactoryGpsd::positionInfoSource(QObject *parent)
 {
-    return new QGeoPositionInfoSourceGpsd(parent);
+    return positionInfoSourceWithParameters(parent, QVariantMap());
 }
 
 QGeoSatelliteInfoSource *QGeoPositionInfoSourceFactoryGpsd::satelliteInfoSource(QObject *parent)
 {
-    return new QGeoSatelliteInfoSourceGpsd(parent);
+    return satelliteInfoSourceWithParameters(parent, QVariantMap());
 }
 
 QGeoAreaMonitorSource *QGeoPositionInfoSourceFactoryGpsd::areaMonitor(QObject *parent)
@@ -43,3 +44,22 @@ QGeoAreaMonitorSource *QGeoPositionInfoSourceFactoryGpsd::areaMonitor(QObject *p
     Q_UNUSED(parent);
     return 0;
 }
+
+QGeoPositionInfoSource *QGeoPositionInfoSourceFactoryGpsd::positionInfoSourceWithParameters(QObject *parent,
+                                                                                            const QVariantMap &parameters)
+{
+    return new QGeoPositionInfoSourceGpsd(GpsdSourceParameters(parameters), parent);
+}
+
+QGeoSatelliteInfoSource *QGeoPositionInfoSourceFactoryGpsd::satelliteInfoSourceWithParameters(QObject *parent,
+                                                                                              const QVariantMap &parameters)
+{
+    return new QGeoSatelliteInfoSourceGpsd(GpsdSourceParameters(parameters), parent);
+}
+
+QGeoAreaMonitorSource *QGeoPositionInfoSourceFactoryGpsd::areaMonitorWithParameters(QObject *parent,
+                                                                                    const QVariantMap &parameters)
+{
+    Q_UNUSED(parameters);
+    return areaMonitor(parent);
+}
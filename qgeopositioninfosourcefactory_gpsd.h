@@ -27,21 +27,40 @@
 #define QGEOPOSITIONINFOSOURCEFACTORY_GPSD_H
 
 #include <QObject>
+#include <QVariantMap>
 #include <qgeopositioninfosourcefactory.h>
 
+// Since Qt 5.14, sources can be configured per instance through the
+// parameters of QGeoPositionInfoSource::createSource(), see
+// GpsdSourceParameters.
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+class QGeoPositionInfoSourceFactoryGpsd : public QObject, public QGeoPositionInfoSourceFactoryV2
+#else
 class QGeoPositionInfoSourceFactoryGpsd : public QObject, public QGeoPositionInfoSourceFactory
+#endif
 {
     Q_OBJECT
 
     Q_PLUGIN_METADATA(IID "org.qt-project.qt.position.sourcefactory/5.0"
                       FILE "plugin.json")
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    Q_INTERFACES(QGeoPositionInfoSourceFactory QGeoPositionInfoSourceFactoryV2)
+#else
     Q_INTERFACES(QGeoPositionInfoSourceFactory)
+#endif
 
 public:
     QGeoPositionInfoSource *positionInfoSource(QObject *parent);
     QGeoSatelliteInfoSource *satelliteInfoSource(QObject *parent);
     QGeoAreaMonitorSource *areaMonitor(QObject *parent);
+
+    QGeoPositionInfoSource *positionInfoSourceWithParameters(QObject *parent,
+                                                             const QVariantMap &parameters);
+    QGeoSatelliteInfoSource *satelliteInfoSourceWithParameters(QObject *parent,
+                                                               const QVariantMap &parameters);
+    QGeoAreaMonitorSource *areaMonitorWithParameters(QObject *parent,
+                                                     const QVariantMap &parameters);
 };
 
 #endif
@@ -25,54 +25,87 @@
 
 #include "qgeosatelliteinfosource_gpsd.h"
 
+#include "gpsdjson.h"
 #include "gpsdmasterdevice.h"
+#include "gpsdmetrics.h"
+#include "gpsdslavedevice.h"
 
 #include <QGeoSatelliteInfo>
 #include <QIODevice>
 #include <QDebug>
 #include <QTimer>
 
-namespace 
+#include <bitset>
+
+namespace
 {
 
-// from qlocationutils.cpp
-bool hasValidNmeaChecksum(const char *data, int size)
+// the assembled view is sorted by system and PRN; PRNs of different systems
+// may be equal
+int viewIndex(const GpsdSky& view, GpsdSatellite::System system, int prn)
 {
-    int asteriskIndex = -1;
-    for (int i = 0; i < size; ++i)
+    int low = 0;
+    int high = view.satelliteCount;
+    while(low < high)
     {
-        if (data[i] == '*')
-        {
-            asteriskIndex = i;
-            break;
-        }
+        int mid = (low + high) / 2;
+        const GpsdSatellite& satellite = view.satellites[mid];
+        if(satellite.system < system || (satellite.system == system && satellite.prn < prn))
+            low = mid + 1;
+        else
+            high = mid;
     }
+    if(low < view.satelliteCount && view.satellites[low].system == system
+            && view.satellites[low].prn == prn)
+        return low;
+    return -1;
+}
 
-    const int CSUM_LEN = 2;
-    if (asteriskIndex < 0 || asteriskIndex + CSUM_LEN >= size)
-        return false;
-
-    // XOR byte value of all characters between '$' and '*'
-    int result = 0;
-    for (int i = 1; i < asteriskIndex; ++i)
-        result ^= data[i];
+QGeoSatelliteInfo::SatelliteSystem toSatelliteSystem(GpsdSatellite::System system)
+{
+    switch(system)
+    {
+    case GpsdSatellite::Gps: return QGeoSatelliteInfo::GPS;
+    case GpsdSatellite::Glonass: return QGeoSatelliteInfo::GLONASS;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    case GpsdSatellite::Galileo: return QGeoSatelliteInfo::GALILEO;
+    case GpsdSatellite::Beidou: return QGeoSatelliteInfo::BEIDOU;
+    case GpsdSatellite::Qzss: return QGeoSatelliteInfo::QZSS;
+#endif
+    default: return QGeoSatelliteInfo::Undefined;
+    }
+}
 
-    QByteArray checkSumBytes(&data[asteriskIndex + 1], 2);
-    bool ok = false;
-    int checksum = checkSumBytes.toInt(&ok,16);
-    return ok && checksum == result;
+QGeoSatelliteInfo toSatelliteInfo(const GpsdSatellite& satellite)
+{
+    QGeoSatelliteInfo info;
+    info.setSatelliteSystem(toSatelliteSystem(satellite.system));
+    info.setSatelliteIdentifier(satellite.prn);
+    if(satellite.elevation >= 0)
+        info.setAttribute(QGeoSatelliteInfo::Elevation, satellite.elevation);
+    if(satellite.azimuth >= 0)
+        info.setAttribute(QGeoSatelliteInfo::Azimuth, satellite.azimuth);
+    info.setSignalStrength(satellite.snr);
+    return info;
 }
 
 }
 
-QGeoSatelliteInfoSourceGpsd::QGeoSatelliteInfoSourceGpsd(QObject* parent)
+QGeoSatelliteInfoSourceGpsd::QGeoSatelliteInfoSourceGpsd(const GpsdSourceParameters& parameters,
+                                                         QObject* parent)
     : QGeoSatelliteInfoSource(parent)
+    , _parameters(parameters)
+    , _master(GpsdMasterDevice::acquire(parameters))
     , _device(0)
     , _lastError(QGeoSatelliteInfoSource::NoError)
     , _running(false)
     , _wasRunning(false)
     , _reqDone(0)
     , _reqTimer(new QTimer(this))
+    , _cachedReceivedAt(0)
+    , _replyingFromCache(false)
+    , _lineReceivedAt(0)
+    , _lastUpdateReceivedAt(0)
 {
     _reqTimer->setSingleShot(true);
     connect(_reqTimer,SIGNAL(timeout()),this, SLOT(reqTimerTimeout()));
@@ -100,6 +133,30 @@ QGeoSatelliteInfoSourceGpsd::minimumUpdateInterval() const
     return 5000;
 }
 
+qint64
+QGeoSatelliteInfoSourceGpsd::lastUpdateReceivedAt() const
+{
+    return _lastUpdateReceivedAt;
+}
+
+QObject*
+QGeoSatelliteInfoSourceGpsd::metrics() const
+{
+    return GpsdMetrics::instance();
+}
+
+QVariantMap
+QGeoSatelliteInfoSourceGpsd::snapshot() const
+{
+    return _snapshot.toVariantMap();
+}
+
+bool
+QGeoSatelliteInfoSourceGpsd::isRequestOnly() const
+{
+    return _reqTimer->isActive() && !_wasRunning;
+}
+
 void
 QGeoSatelliteInfoSourceGpsd::requestUpdate(int timeout)
 {
@@ -119,31 +176,118 @@ QGeoSatelliteInfoSourceGpsd::requestUpdate(int timeout)
     _reqDone = 0;
 
     if(!_running)
+    {
+        // answer from what the master has recently seen if it is fresh enough
+        int maxAge = _master->cacheMaxAge();
+        if(maxAge > 0)
+        {
+            _cachedSnapshot = _master->lastSatelliteSnapshot(maxAge, &_cachedReceivedAt);
+            if(_cachedSnapshot.isValid())
+            {
+                _reqTimer->start(timeout);
+                QTimer::singleShot(0, this, SLOT(replyFromCache()));
+                return;
+            }
+            QList<QByteArray> gsv = _master->recentSentences("GSV", maxAge, &_cachedReceivedAt);
+            QList<QByteArray> gsa = _master->recentSentences("GSA", maxAge);
+            if(!gsv.isEmpty() && !gsa.isEmpty())
+            {
+                _cachedSentences = gsv + gsa;
+                _reqTimer->start(timeout);
+                QTimer::singleShot(0, this, SLOT(replyFromCache()));
+                return;
+            }
+        }
         startUpdates();
+    }
     _reqTimer->start(timeout);
 }
 
+void QGeoSatelliteInfoSourceGpsd::replyFromCache()
+{
+    GpsdSatelliteSnapshot snapshot = _cachedSnapshot;
+    _cachedSnapshot = GpsdSatelliteSnapshot();
+    QList<QByteArray> sentences;
+    sentences.swap(_cachedSentences);
+
+    if(snapshot.isValid())
+    {
+        bool requestOnly = isRequestOnly();
+        if(_reqTimer->isActive())
+        {
+            _reqTimer->stop();
+            _reqDone = ReqSatellitesInView | ReqSatellitesInUse;
+        }
+        else if(!_running)
+            return;
+
+        _snapshot = snapshot;
+        _lastUpdateReceivedAt = _cachedReceivedAt;
+        emit satellitesInViewUpdated(snapshot.satellitesInView());
+        emit satellitesInUseUpdated(snapshot.satellitesInUse());
+        if(!requestOnly)
+            emit snapshotUpdated(snapshot.toVariantMap());
+        return;
+    }
+
+    if(!_reqTimer->isActive())
+        return;
+
+    _replyingFromCache = true;
+    _lineReceivedAt = _cachedReceivedAt;
+    foreach(const QByteArray& sentence, sentences)
+        parseNmeaData(sentence.constData(), sentence.size());
+    // the cache holds one epoch, nothing follows to complete it
+    handleCompleted(_skyAssembler.flush());
+    _replyingFromCache = false;
+
+    // the cached view was incomplete, wait for the live stream instead
+    if(_reqTimer->isActive() && !_running)
+        startUpdates();
+}
+
 QGeoSatelliteInfoSourceGpsd::~QGeoSatelliteInfoSourceGpsd()
 {
     if(_running)
         stopUpdates();
+    if(_device)
+        _master->destroySlave(_device);
+    _device = 0;
+    GpsdMasterDevice::release(_master);
 }
 
 void QGeoSatelliteInfoSourceGpsd::startUpdates()
 {
     if(!_running)
     {
-        _device = GpsdMasterDevice::instance()->createSlave();
+        // the slave is kept across start/stop cycles and only destroyed
+        // together with the source
         if(!_device)
+        {
+            _device = _master->createSlave();
+            if(_device)
+            {
+                _device->setSynchronous(_parameters.highRate);
+                _device->reserve(_parameters.bufferSize);
+                connect(_device,SIGNAL(readyRead()),this,SLOT(tryReadLine()));
+            }
+        }
+        if(!_device || !_master->unpauseSlave(_device))
         {
             _lastError = QGeoSatelliteInfoSource::AccessError;
             emit QGeoSatelliteInfoSource::error(_lastError);
             return;
         }
-
-        connect(_device,SIGNAL(readyRead()),this,SLOT(tryReadLine()));
-        GpsdMasterDevice::instance()->unpauseSlave(_device);
         _running = true;
+
+        // start off with the sky view another source has just seen
+        if(_master->cacheMaxAge() > 0)
+        {
+            _cachedSnapshot = _master->lastSatelliteSnapshot(_master->cacheMaxAge(),
+                                                             &_cachedReceivedAt);
+            if(_cachedSnapshot.isValid())
+                QTimer::singleShot(0, this, SLOT(replyFromCache()));
+        }
     }
 }
 
@@ -151,11 +295,8 @@ void QGeoSatelliteInfoSourceGpsd::stopUpdates()
 {
     if(_running)
     {
-        disconnect(_device,SIGNAL(readyRead()),this,SLOT(tryReadLine()));
-        GpsdMasterDevice::instance()->pauseSlave(_device);
+        _master->pauseSlave(_device);
         _running = false;
-        GpsdMasterDevice::instance()->destroySlave(_device);
-        _device = 0;
     }
 }
 
@@ -163,122 +304,86 @@ void QGeoSatelliteInfoSourceGpsd::tryReadLine()
 {
     while(_device->canReadLine())
     {
-        QByteArray buf(_device->readLine());
-        parseNmeaData(buf, buf.size());
+        // a line longer than the buffer is read in several parts
+        int size = 0;
+        do
+        {
+            if(_lineBuffer.size() - size < 2)
+                _lineBuffer.resize(qMax(2 * _lineBuffer.size(), 1024));
+            qint64 got = _device->readLine(_lineBuffer.data() + size, _lineBuffer.size() - size);
+            if(got <= 0)
+                break;
+            size += int(got);
+        } while(_lineBuffer.at(size - 1) != '\n');
+        if(size == 0)
+            break;
+        _lineReceivedAt = _device->lastReadTimestamp();
+        parseNmeaData(_lineBuffer.constData(), size);
     }
 }
 
-void QGeoSatelliteInfoSourceGpsd::readGSV(const char *data, int size)
+void QGeoSatelliteInfoSourceGpsd::updateSatellitesInView()
+{
+    // built once per epoch and shared by the signals and the snapshot
+    const GpsdSky& view = _skyAssembler.view();
+    _satellitesInView.clear();
+    _satellitesInView.reserve(view.satelliteCount);
+    for(int i=0; i<view.satelliteCount; ++i)
+        _satellitesInView.append(toSatelliteInfo(view.satellites[i]));
+}
+
+void QGeoSatelliteInfoSourceGpsd::viewCompleted()
 {
-    static QMap<int,QGeoSatelliteInfo> sats;
-    /*
-    $GPGSV,2,1,08,01,40,083,46,02,17,308,41,12,07,344,39,14,22,228,45*75
-    Where:
-    
-      GSV          Satellites in view
-      2            Number of sentences for full data
-      1            sentence 1 of 2
-      08           Number of satellites in view
-      
-      01           Satellite PRN number
-      40           Elevation, degrees
-      083          Azimuth, degrees
-      46           SNR - higher is better
-         for up to 4 satellites per sentence
-      *75          the checksum data, always begins with *
-  */
-    QList<QByteArray> parts = QByteArray::fromRawData(data,size).split(',');
-
-    int senMax = parts[1].toUInt();
-    int senIdx = parts[2].toUInt();
-    int nSats  = parts[3].toUInt();
-
-    if( senIdx == 1)
-        sats.clear();
-
-    int pos = 4;
-    for( int sat=0; (sat+1)*4 < parts.size()-3; ++sat)
+    bool emitSignal = true;
+    if(_reqTimer->isActive())
     {
-        QGeoSatelliteInfo info;
-        int prn = parts[pos++].toUInt();
-        int ele = parts[pos++].toUInt();
-        int azi = parts[pos++].toUInt();
-        int snr = parts[pos++].toUInt();
-        info.setSatelliteSystem(QGeoSatelliteInfo::GPS);
-        info.setSatelliteIdentifier(prn);
-        info.setAttribute(QGeoSatelliteInfo::Elevation, ele);
-        info.setAttribute(QGeoSatelliteInfo::Azimuth, azi);
-        info.setSignalStrength(snr);
-        sats[prn] = info;
+        if(!(_reqDone & ReqSatellitesInView))
+            _reqDone |= ReqSatellitesInView;
+        if(!_wasRunning)
+            emitSignal = false;
     }
 
-    // last sentence
-    if( senIdx == senMax)
+    if(!emitSignal && GpsdMetrics::isEnabled())
+        GpsdMetrics::add(GpsdMetrics::SuppressedEmissions);
+    if(emitSignal)
     {
-        if( sats.size() != nSats)
-            qInfo() << "nSats != sats.size()!" << nSats << sats.size();
-        _satellitesInView = sats;
-
-        bool emitSignal = true;
-        if(_reqTimer->isActive())
-        {
-            if(!(_reqDone & ReqSatellitesInView))
-                _reqDone |= ReqSatellitesInView;
-            if(!_wasRunning)
-                emitSignal = false;
-        }
-
-        if(emitSignal)
-            emit satellitesInViewUpdated(_satellitesInView.values());
+        _lastUpdateReceivedAt = _skyAssembler.viewReceivedAt();
+        emit satellitesInViewUpdated(_satellitesInView);
     }
 }
 
-void QGeoSatelliteInfoSourceGpsd::readGSA(const char *data, int size)
+void QGeoSatelliteInfoSourceGpsd::useCompleted()
 {
-    /*
-    $GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39
-
-    Where:
-      GSA      Satellite status
-      A        Auto selection of 2D or 3D fix (M = manual)
-      3        3D fix - values include: 1 = no fix
-                                        2 = 2D fix
-                                        3 = 3D fix
-      04,05... PRNs of satellites used for fix (space for 12)
-      2.5      PDOP (dilution of precision)
-      1.3      Horizontal dilution of precision (HDOP)
-      2.1      Vertical dilution of precision (VDOP)
-      *39      the checksum data, always begins with *
-  */
-
     if(!_satellitesInView.size()) return;
 
-    QList<QByteArray> parts = QByteArray::fromRawData(data, size).split(',');
-    //int fixType = parts[2].toUInt();
-
-    QSet<int> satsInUse;
-    for(int i=3; i<15; ++i)
-    {
-        if( parts[i].isEmpty()) continue;
-        int prn = parts[i].toUInt();
-        satsInUse.insert(prn);
-    }
-
-    QList<QGeoSatelliteInfo> satellitesInUse;
-    QSetIterator<int> setIt(satsInUse);
-    while(setIt.hasNext())
+    const GpsdSky& view = _skyAssembler.view();
+    const GpsdNmea::Gsa& use = _skyAssembler.use();
+    std::bitset<GpsdSky::MaxSatellites> used;
+    bool found = true;
+    for(int i=0; i<use.prnCount; ++i)
     {
-        int prn = setIt.next();
-        QMap<int,QGeoSatelliteInfo>::const_iterator mapIt =
-                _satellitesInView.find(prn);
-        if( mapIt == _satellitesInView.end())
-            qInfo() << "Used sat" << prn << "not found";
+        int index = viewIndex(view, use.systems[i], use.prns[i]);
+        if(index < 0)
+        {
+            qInfo() << "Used sat" << use.prns[i] << "of system" << use.systems[i] << "not found";
+            found = false;
+        }
         else
-            satellitesInUse.append(mapIt.value());
+            used.set(index);
     }
+    if(!found && GpsdMetrics::isEnabled())
+        GpsdMetrics::add(GpsdMetrics::SuppressedEmissions);
 
-    if(satellitesInUse.size() == satsInUse.size())
+    if(found)
     {
+        QList<QGeoSatelliteInfo> satellitesInUse;
+        satellitesInUse.reserve(int(used.count()));
+        for(int i=0; i<_satellitesInView.size(); ++i)
+        {
+            if(used.test(i))
+                satellitesInUse.append(_satellitesInView.at(i));
+        }
+
         bool emitSignal = true;
         if(_reqTimer->isActive())
         {
@@ -290,45 +395,101 @@ void QGeoSatelliteInfoSourceGpsd::readGSA(const char *data, int size)
                 _reqTimer->stop();
                 if(!_wasRunning)
                     QTimer::singleShot(0, this, SLOT(stopUpdates()));
-                emit satellitesInViewUpdated( _satellitesInView.values());
+                _lastUpdateReceivedAt = _skyAssembler.viewReceivedAt();
+                emit satellitesInViewUpdated( _satellitesInView);
             }
             else if(!_wasRunning)
                 emitSignal = false;
         }
+        if(!emitSignal && GpsdMetrics::isEnabled())
+            GpsdMetrics::add(GpsdMetrics::SuppressedEmissions);
         if(emitSignal)
         {
+            _lastUpdateReceivedAt = qMin(_skyAssembler.viewReceivedAt(),
+                                         _skyAssembler.useReceivedAt());
             emit satellitesInUseUpdated( satellitesInUse);
         }
     }
 }
 
-bool QGeoSatelliteInfoSourceGpsd::parseNmeaData(const char *data, int size)
+void QGeoSatelliteInfoSourceGpsd::skyCompleted()
 {
-    if (size < 6 || data[0] != '$' || !hasValidNmeaChecksum(data, size))
-        return false;
+    // the sky is the current view with its satellites in use marked
+    const GpsdSky& sky = _skyAssembler.sky();
+    QList<QGeoSatelliteInfo> satellitesInUse;
+    for(int i=0; i<sky.satelliteCount && i<_satellitesInView.size(); ++i)
+    {
+        if(sky.satellites[i].used)
+            satellitesInUse.append(_satellitesInView.at(i));
+    }
 
-    // subtract checksum from data size
-    for (int i = 0; i < size; ++i)
+    _snapshot = GpsdSatelliteSnapshot(_satellitesInView, satellitesInUse,
+                                      GpsdSatelliteSnapshot::FixMode(sky.fixMode),
+                                      sky.pdop, sky.hdop, sky.vdop);
+    _lastUpdateReceivedAt = _skyAssembler.skyReceivedAt();
+    if(!_replyingFromCache)
     {
-        if (data[i] == '*')
+        _master->setLastSatelliteSnapshot(_snapshot, _lastUpdateReceivedAt);
+        if(GpsdMetrics::isEnabled())
         {
-            size = i;
-            break;
+            GpsdMetrics::add(GpsdMetrics::EpochsEmitted);
+            GpsdMetrics::record(GpsdMetrics::DeliveryLatency,
+                                GpsdMasterDevice::monotonicNsecs() - _lastUpdateReceivedAt);
         }
     }
+    // a request is answered by the standard signals alone, which are
+    // emitted as view and use complete; the snapshot property is current
+    // either way
+    if(isRequestOnly())
+    {
+        if(GpsdMetrics::isEnabled())
+            GpsdMetrics::add(GpsdMetrics::SuppressedEmissions);
+        return;
+    }
+    emit snapshotUpdated(_snapshot.toVariantMap());
+}
 
-    if (data[3] == 'G' && data[4] == 'S' && data[5] == 'A')
+bool QGeoSatelliteInfoSourceGpsd::parseNmeaData(const char *data, int size)
+{
+    unsigned int completed;
+    if(!GpsdMetrics::isEnabled())
+        completed = parseSky(data, size);
+    else
     {
-        // detailed satellite data
-        readGSA(data, size);
-        return true;
+        qint64 start = GpsdMasterDevice::monotonicNsecs();
+        completed = parseSky(data, size);
+        GpsdMetrics::record(GpsdMetrics::ParseTime, GpsdMasterDevice::monotonicNsecs() - start);
     }
-    else if (data[3] == 'G' && data[4] == 'S' && data[5] == 'V')
+    handleCompleted(completed);
+    return completed != 0;
+}
+
+unsigned int QGeoSatelliteInfoSourceGpsd::parseSky(const char *data, int size)
+{
+    if(_parameters.mode == GpsdSourceParameters::JsonMode)
     {
-        // detailed satellite data
-        readGSV(data, size);
-        return true;
+        GpsdSky sky;
+        if(GpsdJson::decodeSKY(data, size, &sky))
+            return _skyAssembler.addSky(sky, _lineReceivedAt);
+        if(GpsdMetrics::isEnabled() && GpsdJson::isClass(data, size, "SKY"))
+            GpsdMetrics::add(GpsdMetrics::ParseErrors);
+        return 0;
     }
+    unsigned int completed = _skyAssembler.addSentence(data, size, _lineReceivedAt);
+    if(_skyAssembler.rejected() && GpsdMetrics::isEnabled())
+        GpsdMetrics::add(GpsdMetrics::ParseErrors);
+    return completed;
+}
 
-    return false;
+void QGeoSatelliteInfoSourceGpsd::handleCompleted(unsigned int completed)
+{
+    if(completed & GpsdSkyAssembler::ViewCompleted)
+        updateSatellitesInView();
+    // a snapshot is announced before the signals of the sentence completing it
+    if(completed & GpsdSkyAssembler::SkyCompleted)
+        skyCompleted();
+    if(completed & GpsdSkyAssembler::ViewCompleted)
+        viewCompleted();
+    if(completed & GpsdSkyAssembler::UseCompleted)
+        useCompleted();
 }
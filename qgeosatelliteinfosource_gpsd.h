@@ -26,23 +26,50 @@
 #ifndef QGEOSATELLITEINFOSOURCE_GPSD_H
 #define QGEOSATELLITEINFOSOURCE_GPSD_H
 
+#include "gpsdsatellitesnapshot.h"
+#include "gpsdskyassembler.h"
+#include "gpsdsourceparameters.h"
+
 #include <QGeoSatelliteInfoSource>
-#include <QMap>
+#include <QList>
+#include <QVariantMap>
 
-class QIODevice;
+class GpsdMasterDevice;
+class GpsdSlaveDevice;
 class QTimer;
 
 class QGeoSatelliteInfoSourceGpsd : public QGeoSatelliteInfoSource
 {
     Q_OBJECT
 
+    // CLOCK_MONOTONIC time in ns at which the oldest data of the last
+    // update was read from the gpsd socket, valid while an update signal
+    // is handled
+    Q_PROPERTY(qint64 lastUpdateReceivedAt READ lastUpdateReceivedAt)
+
+    // the process-wide GpsdMetrics, see gpsdmetrics.h
+    Q_PROPERTY(QObject* metrics READ metrics CONSTANT)
+
+    // sky view of the last complete epoch, see
+    // GpsdSatelliteSnapshot::toVariantMap()
+    Q_PROPERTY(QVariantMap snapshot READ snapshot NOTIFY snapshotUpdated)
+
 public:
-    explicit QGeoSatelliteInfoSourceGpsd(QObject* parent=0);
+    explicit QGeoSatelliteInfoSourceGpsd(const GpsdSourceParameters& parameters,
+                                         QObject* parent=0);
     ~QGeoSatelliteInfoSourceGpsd();
 
     Error error() const;
     int   minimumUpdateInterval() const;
 
+    qint64 lastUpdateReceivedAt() const;
+    QObject* metrics() const;
+    QVariantMap snapshot() const;
+
+signals:
+    // once per epoch while updates are started, not for requestUpdate()
+    void snapshotUpdated(const QVariantMap& snapshot);
+
 public slots:
     void requestUpdate(int timeout=0);
     void startUpdates();
@@ -51,22 +78,44 @@ public slots:
 private slots:
     void tryReadLine();
     void reqTimerTimeout();
+    void replyFromCache();
 
 private:
     static const unsigned int ReqSatellitesInView = 0x1;
     static const unsigned int ReqSatellitesInUse  = 0x2;
 
+    // running only to answer requestUpdate()
+    bool isRequestOnly() const;
+
     bool parseNmeaData(const char* data, int size);
-    void readGSA(const char* data, int size);
-    void readGSV(const char* data, int size);
+    unsigned int parseSky(const char* data, int size);
+    void handleCompleted(unsigned int completed);
+    void updateSatellitesInView();
+    void viewCompleted();
+    void useCompleted();
+    void skyCompleted();
 
-    QIODevice* _device;
-    QMap<int,QGeoSatelliteInfo> _satellitesInView;
+    GpsdSourceParameters _parameters;
+    GpsdMasterDevice* _master;
+    GpsdSlaveDevice* _device;
+    GpsdSkyAssembler _skyAssembler;
+    // in the order of the assembled view, by system and PRN
+    QList<QGeoSatelliteInfo> _satellitesInView;
+    QList<QByteArray> _cachedSentences;
     Error _lastError;
     bool _running;
     bool _wasRunning;
     unsigned int _reqDone;
     QTimer* _reqTimer;
+    GpsdSatelliteSnapshot _cachedSnapshot;
+    qint64 _cachedReceivedAt;
+    bool _replyingFromCache;
+
+    // lines are read into the same buffer, which only ever grows
+    QByteArray _lineBuffer;
+    qint64 _lineReceivedAt;
+    qint64 _lastUpdateReceivedAt;
+    GpsdSatelliteSnapshot _snapshot;
 };
 
 #endif // QGEOSATELLITEINFOSOURCE_GPSD_H
@@ -9,16 +9,30 @@ INSTALLS += target
 TEMPLATE = lib
 CONFIG += plugin
 
+include(core/gpsdcore.pri)
+
 HEADERS += \
+    gpsdkalmanfilter.h \
     gpsdmasterdevice.h \
+    gpsdmetrics.h \
+    gpsdpositionpredictor.h \
+    gpsdsatellitesnapshot.h \
+    gpsdslavedevice.h \
+    gpsdsourceparameters.h \
     qgeopositioninfosource_gpsd.h \
     qgeopositioninfosourcefactory_gpsd.h \
     qgeosatelliteinfosource_gpsd.h
 
 SOURCES += \
+    gpsdkalmanfilter.cpp \
     gpsdmasterdevice.cpp \
+    gpsdmetrics.cpp \
+    gpsdpositionpredictor.cpp \
+    gpsdsatellitesnapshot.cpp \
+    gpsdslavedevice.cpp \
+    gpsdsourceparameters.cpp \
     qgeopositioninfosource_gpsd.cpp \
     qgeopositioninfosourcefactory_gpsd.cpp \
     qgeosatelliteinfosource_gpsd.cpp
 
-OTHER_FILES += plugin.json
+OTHER_FILES += plugin.json core/core.pro
@@ -0,0 +1,17 @@
+# gpsd stand-in serving synthetic or recorded data, for testing the plugin
+# without a receiver
+TARGET = fakegpsd
+QT = core network
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+include(../../core/gpsdcore.pri)
+
+HEADERS += \
+    fakegpsdserver.h
+
+SOURCES += \
+    fakegpsdserver.cpp \
+    main.cpp
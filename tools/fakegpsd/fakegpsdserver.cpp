@@ -0,0 +1,386 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "fakegpsdserver.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QRegularExpression>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+namespace
+{
+
+const char* const Device = "/dev/fake0";
+
+QByteArray version()
+{
+    return "{\"class\":\"VERSION\",\"release\":\"3.17\",\"rev\":\"fake\","
+           "\"proto_major\":3,\"proto_minor\":12}\r\n";
+}
+
+QByteArray isoTime(const QDateTime& time)
+{
+    return time.toString("yyyy-MM-dd'T'HH:mm:ss.zzz'Z'").toLatin1();
+}
+
+QByteArray devices()
+{
+    return QByteArray("{\"class\":\"DEVICES\",\"devices\":[{\"class\":\"DEVICE\",\"path\":\"")
+            + Device + "\",\"driver\":\"NMEA0183\",\"activated\":\""
+            + isoTime(QDateTime::currentDateTimeUtc()) + "\",\"native\":0}]}\r\n";
+}
+
+bool watchFlag(const QByteArray& command, const char* name, bool defaultValue)
+{
+    QRegularExpression re(QString("\"%1\"\\s*:\\s*(true|false)").arg(name));
+    QRegularExpressionMatch match = re.match(QString::fromLatin1(command));
+    return match.hasMatch() ? match.captured(1) == "true" : defaultValue;
+}
+
+}
+
+FakeGpsdServer::Options::Options()
+    : port(2947)
+    , rate(1.0)
+    , satellites(12)
+    , constellations(5)
+    , speed(1.0)
+    , maxClients(64)
+    , disconnectInterval(0)
+    , partialLines(false)
+    , badChecksums(0.0)
+    , seed(1)
+{
+}
+
+FakeGpsdServer::FakeGpsdServer(const Options& options, QObject* parent)
+    : QObject(parent)
+    , _options(options)
+    , _server(new QTcpServer(this))
+    , _feedTimer(new QTimer(this))
+    , _disconnectTimer(new QTimer(this))
+    , _random(options.seed)
+    , _scenario(0)
+    , _log(0)
+    , _logPending(false)
+    , _logOrigin(0)
+{
+    _feedTimer->setTimerType(Qt::PreciseTimer);
+    connect(_server, SIGNAL( newConnection()), this, SLOT( acceptClients()));
+    connect(_disconnectTimer, SIGNAL( timeout()), this, SLOT( disconnectClients()));
+}
+
+FakeGpsdServer::~FakeGpsdServer()
+{
+    delete _scenario;
+#ifdef Q_OS_UNIX
+    delete _log;
+#endif
+}
+
+bool FakeGpsdServer::start()
+{
+    if(!_server->listen(QHostAddress::Any, _options.port))
+    {
+        qCritical() << "Could not listen on port" << _options.port << _server->errorString();
+        return false;
+    }
+
+    if(!_options.logFile.isEmpty())
+    {
+#ifdef Q_OS_UNIX
+        _log = new GpsdLogReader;
+        if(!_log->open(QFile::encodeName(_options.logFile).constData()))
+        {
+            qCritical() << "Could not open log" << _options.logFile;
+            return false;
+        }
+        _feedTimer->setSingleShot(true);
+        connect(_feedTimer, SIGNAL( timeout()), this, SLOT( sendLogLines()));
+        _logPending = _log->next(&_logEntry);
+        _logOrigin = _logEntry.receivedAt;
+        _feedTimer->start(0);
+#else
+        // GpsdLogReader is built on POSIX systems only
+        qCritical() << "Serving a log is not supported on this platform";
+        return false;
+#endif
+    }
+    else
+    {
+        // the scenario starts now, so that clients see current fixes
+        GpsdScenario::Options scenario;
+        scenario.seed = _options.seed;
+        scenario.rate = _options.rate;
+        scenario.satellites = _options.satellites;
+        scenario.constellations = _options.constellations;
+        scenario.startTime = QDateTime::currentMSecsSinceEpoch();
+        _scenario = new GpsdScenario(scenario);
+        _feedTimer->setSingleShot(true);
+        connect(_feedTimer, SIGNAL( timeout()), this, SLOT( sendSyntheticEpoch()));
+        _feedTimer->start(0);
+    }
+
+    _clock.start();
+    if(_options.disconnectInterval > 0)
+        _disconnectTimer->start(_options.disconnectInterval);
+    qInfo() << "Serving" << Device << "on port" << _server->serverPort();
+    return true;
+}
+
+void FakeGpsdServer::acceptClients()
+{
+    while(QTcpSocket* socket = _server->nextPendingConnection())
+    {
+        if(_clients.size() >= _options.maxClients)
+        {
+            qInfo() << "Refusing client, already serving" << _clients.size();
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+        Client* client = new Client;
+        client->socket = socket;
+        client->watching = false;
+        client->nmea = false;
+        client->json = false;
+        _clients.append(client);
+        connect(socket, SIGNAL( readyRead()), this, SLOT( readCommands()));
+        connect(socket, SIGNAL( disconnected()), this, SLOT( removeClient()));
+        socket->write(version());
+        qInfo() << "Client connected," << _clients.size() << "in total";
+    }
+}
+
+FakeGpsdServer::Client* FakeGpsdServer::findClient(QObject* socket)
+{
+    foreach(Client* client, _clients)
+    {
+        if(client->socket == socket)
+            return client;
+    }
+    return 0;
+}
+
+void FakeGpsdServer::readCommands()
+{
+    Client* client = findClient(sender());
+    if(!client)
+        return;
+    client->commands += client->socket->readAll();
+
+    // commands end with ';' or a line feed
+    int start = 0;
+    for(int i=0; i<client->commands.size(); ++i)
+    {
+        if(client->commands[i] != ';' && client->commands[i] != '\n')
+            continue;
+        QByteArray command = client->commands.mid(start, i - start).trimmed();
+        if(!command.isEmpty())
+            handleCommand(client, command);
+        start = i + 1;
+    }
+    client->commands.remove(0, start);
+}
+
+void FakeGpsdServer::handleCommand(Client* client, const QByteArray& command)
+{
+    if(command.startsWith("?WATCH"))
+    {
+        client->watching = watchFlag(command, "enable", true);
+        client->nmea = watchFlag(command, "nmea", client->nmea);
+        client->json = watchFlag(command, "json", client->json);
+        // gpsd sends reports of other devices to nobody
+        QRegularExpression re("\"device\"\\s*:\\s*\"([^\"]*)\"");
+        QRegularExpressionMatch match = re.match(QString::fromLatin1(command));
+        if(match.hasMatch() && match.captured(1) != Device)
+            client->watching = false;
+        client->socket->write(devices());
+        client->socket->write(QString("{\"class\":\"WATCH\",\"enable\":%1,\"json\":%2,\"nmea\":%3}\r\n")
+                              .arg(client->watching ? "true" : "false")
+                              .arg(client->json ? "true" : "false")
+                              .arg(client->nmea ? "true" : "false").toLatin1());
+    }
+    else if(command.startsWith("?POLL"))
+    {
+        client->socket->write("{\"class\":\"POLL\",\"time\":\""
+                              + isoTime(QDateTime::currentDateTimeUtc())
+                              + "\",\"active\":1,\"tpv\":[" + _lastTpv + "],\"sky\":[" + _lastSky + "]}\r\n");
+    }
+    else if(command.startsWith("?VERSION"))
+    {
+        client->socket->write(version());
+    }
+    else if(command.startsWith("?DEVICES"))
+    {
+        client->socket->write(devices());
+    }
+    else
+    {
+        client->socket->write("{\"class\":\"ERROR\",\"message\":\"Unrecognized request\"}\r\n");
+    }
+}
+
+void FakeGpsdServer::removeClient()
+{
+    Client* client = findClient(sender());
+    if(!client)
+        return;
+    _clients.removeOne(client);
+    client->socket->deleteLater();
+    delete client;
+    qInfo() << "Client disconnected," << _clients.size() << "left";
+}
+
+void FakeGpsdServer::disconnectClients()
+{
+    qInfo() << "Dropping" << _clients.size() << "clients";
+    foreach(Client* client, _clients)
+        client->socket->abort();
+}
+
+void FakeGpsdServer::damageChecksum(QByteArray& line)
+{
+    // in place, keeping the line length
+    int star = line.indexOf('*');
+    if(_options.badChecksums > 0.0 && star > 0 && star + 1 < line.size()
+       && std::uniform_real_distribution<double>(0.0, 1.0)(_random) < _options.badChecksums)
+        line[star + 1] = line[star + 1] == '0' ? '1' : '0';
+}
+
+void FakeGpsdServer::sendSyntheticEpoch()
+{
+    _scenario->next();
+
+    std::string text;
+    _scenario->appendNmea(&text);
+    QByteArray nmea;
+    int start = 0;
+    while(start < int(text.size()))
+    {
+        int end = int(text.find('\n', start)) + 1;
+        QByteArray line(text.data() + start, end - start);
+        damageChecksum(line);
+        nmea += line;
+        start = end;
+    }
+
+    text.clear();
+    _scenario->appendTpv(&text, Device);
+    _lastTpv = QByteArray(text.data(), int(text.size()));
+    text.clear();
+    _scenario->appendSky(&text, Device);
+    _lastSky = QByteArray(text.data(), int(text.size()));
+
+    send(nmea, _lastTpv + "\r\n" + _lastSky + "\r\n");
+
+    // due by the clock, so that the epoch times keep up with it
+    qint64 due = qint64((_scenario->epoch() + 1) * 1e9 / _options.rate);
+    _feedTimer->start(int(qMax(due - _clock.nsecsElapsed(), qint64(0)) / 1000000));
+}
+
+void FakeGpsdServer::sendLogLines()
+{
+#ifdef Q_OS_UNIX
+    qint64 now = _clock.nsecsElapsed();
+    QByteArray nmea;
+    QByteArray json;
+    for(; _logPending; _logPending = _log->next(&_logEntry))
+    {
+        if(_options.speed > 0.0)
+        {
+            qint64 due = qint64((_logEntry.receivedAt - _logOrigin) / _options.speed);
+            if(due > now)
+            {
+                _feedTimer->start(int((due - now + 999999) / 1000000));
+                break;
+            }
+        }
+        else if(nmea.size() + json.size() > 65536)
+        {
+            _feedTimer->start(0);
+            break;
+        }
+
+        QByteArray line(_logEntry.data, _logEntry.size);
+        if(!line.endsWith('\n'))
+            line += "\r\n";
+        if(line.startsWith('{'))
+        {
+            json += line;
+            if(line.contains("\"class\":\"TPV\""))
+                _lastTpv = line.trimmed();
+            else if(line.contains("\"class\":\"SKY\""))
+                _lastSky = line.trimmed();
+        }
+        else if(line.startsWith('$'))
+        {
+            damageChecksum(line);
+            nmea += line;
+        }
+    }
+    send(nmea, json);
+    if(!_logPending)
+        qInfo() << "End of log" << _options.logFile;
+#endif
+}
+
+void FakeGpsdServer::send(const QByteArray& nmea, const QByteArray& json)
+{
+    foreach(Client* client, _clients)
+    {
+        if(!client->watching)
+            continue;
+        QByteArray data;
+        if(client->nmea)
+            data += nmea;
+        if(client->json)
+            data += json;
+        write(client, data);
+    }
+}
+
+void FakeGpsdServer::write(Client* client, const QByteArray& data)
+{
+    if(!_options.partialLines)
+    {
+        client->socket->write(data);
+        return;
+    }
+
+    // hold back the tail of the data until the next write, so that the
+    // client reads a partial line in between
+    QByteArray all = client->heldBack + data;
+    if(all.isEmpty())
+        return;
+    int split = std::uniform_int_distribution<int>(1, all.size())(_random);
+    client->socket->write(all.constData(), split);
+    client->socket->flush();
+    client->heldBack = all.mid(split);
+}
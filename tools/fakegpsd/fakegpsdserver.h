@@ -0,0 +1,119 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef FAKEGPSDSERVER_H
+#define FAKEGPSDSERVER_H
+
+#include "gpsdlogreader.h"
+#include "gpsdscenario.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include <random>
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+// Stand-in for gpsd speaking enough of its protocol for the plugin and
+// for clients polling it: VERSION on connect, ?WATCH, ?POLL, ?VERSION and
+// ?DEVICES. It serves one device, either with the epochs of a GpsdScenario
+// or with the lines of a recorded log, and can inject faults.
+class FakeGpsdServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options
+    {
+        Options();
+
+        quint16 port;
+        double rate;            // synthetic epochs per second
+        int satellites;         // synthetic satellites in view
+        int constellations;     // of the synthetic sky, see GpsdScenario
+        QString logFile;        // serve this log instead, see GpsdLogReader
+        double speed;           // log replay speed, 0 for maximum
+        int maxClients;
+        int disconnectInterval; // ms between dropping all clients, 0 never
+        bool partialLines;      // split writes in the middle of lines
+        double badChecksums;    // fraction of NMEA sentences to damage
+        quint32 seed;
+    };
+
+    explicit FakeGpsdServer(const Options& options, QObject* parent = 0);
+    ~FakeGpsdServer();
+
+    bool start();
+
+private slots:
+    void acceptClients();
+    void readCommands();
+    void removeClient();
+    void sendSyntheticEpoch();
+    void sendLogLines();
+    void disconnectClients();
+
+private:
+    struct Client
+    {
+        QTcpSocket* socket;
+        QByteArray commands;
+        bool watching;
+        bool nmea;
+        bool json;
+        QByteArray heldBack;    // rest of a split write
+    };
+
+    Client* findClient(QObject* socket);
+    void handleCommand(Client* client, const QByteArray& command);
+    void send(const QByteArray& nmea, const QByteArray& json);
+    void write(Client* client, const QByteArray& data);
+    void damageChecksum(QByteArray& line);
+
+    Options _options;
+    QTcpServer* _server;
+    QTimer* _feedTimer;
+    QTimer* _disconnectTimer;
+    QList<Client*> _clients;
+    std::mt19937 _random;
+
+    // the latest reports, for ?POLL
+    QByteArray _lastTpv;
+    QByteArray _lastSky;
+
+    GpsdScenario* _scenario;
+    QElapsedTimer _clock;
+    GpsdLogReader* _log;
+    GpsdLogReader::Entry _logEntry;
+    bool _logPending;
+    qint64 _logOrigin;
+};
+
+#endif // FAKEGPSDSERVER_H
@@ -0,0 +1,75 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "fakegpsdserver.h"
+#include "gpsdscenario.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("fakegpsd");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("gpsd stand-in serving synthetic or recorded data");
+    parser.addHelpOption();
+    QCommandLineOption port("port", "TCP port to listen on.", "port", "2947");
+    QCommandLineOption rate("rate", "Synthetic epochs per second.", "hz", "1");
+    QCommandLineOption satellites("satellites", "Synthetic satellites in view.", "count", "12");
+    QCommandLineOption constellations("constellations", "Synthetic constellations, GPS first.", "count", "5");
+    QCommandLineOption log("log", "Serve a recorded log or NMEA/JSON text file instead.", "file");
+    QCommandLineOption speed("speed", "Log replay speed, 0 for maximum.", "factor", "1");
+    QCommandLineOption clients("max-clients", "Clients served at once.", "count", "64");
+    QCommandLineOption disconnect("disconnect", "Drop all clients every so many ms.", "ms", "0");
+    QCommandLineOption partial("partial-lines", "Split writes in the middle of lines.");
+    QCommandLineOption badChecksums("bad-checksums", "Fraction of NMEA sentences with a wrong checksum.",
+                                    "fraction", "0");
+    QCommandLineOption seed("seed", "Seed of the synthetic data and the fault injection.", "seed", "1");
+    parser.addOptions(QList<QCommandLineOption>() << port << rate << satellites << constellations
+                      << log << speed << clients << disconnect << partial << badChecksums << seed);
+    parser.process(app);
+
+    FakeGpsdServer::Options options;
+    options.port = parser.value(port).toUShort();
+    options.rate = qMax(parser.value(rate).toDouble(), 0.01);
+    options.constellations = qBound(1, parser.value(constellations).toInt(), 5);
+    options.satellites = qBound(0, parser.value(satellites).toInt(),
+                                GpsdScenario::maxSatellites(options.constellations));
+    options.logFile = parser.value(log);
+    options.speed = qMax(parser.value(speed).toDouble(), 0.0);
+    options.maxClients = parser.value(clients).toInt();
+    options.disconnectInterval = parser.value(disconnect).toInt();
+    options.partialLines = parser.isSet(partial);
+    options.badChecksums = parser.value(badChecksums).toDouble();
+    options.seed = parser.value(seed).toUInt();
+
+    FakeGpsdServer server(options);
+    if(!server.start())
+        return 1;
+    return app.exec();
+}
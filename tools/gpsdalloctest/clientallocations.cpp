@@ -0,0 +1,172 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "clientallocations.h"
+
+#include "gpsdallocationcounter.h"
+#include "gpsdclient.h"
+#include "gpsdepochassembler.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+class CountingHandler : public GpsdClient::Handler
+{
+public:
+    CountingHandler()
+        : fixes(0)
+    {
+    }
+
+    void fixReceived(const GpsdFix&, int64_t)
+    {
+        ++fixes;
+    }
+
+    void skyReceived(const GpsdSky&, int64_t)
+    {
+    }
+
+    int fixes;
+};
+
+int listenOnLoopback(uint16_t* port)
+{
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address = sockaddr_in();
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t size = sizeof(address);
+    if(server < 0 || bind(server, reinterpret_cast<struct sockaddr*>(&address), size) != 0
+            || listen(server, 1) != 0
+            || getsockname(server, reinterpret_cast<struct sockaddr*>(&address), &size) != 0)
+    {
+        if(server >= 0)
+            ::close(server);
+        return -1;
+    }
+    *port = ntohs(address.sin_port);
+    return server;
+}
+
+bool writeAll(int fd, const char* data, size_t size)
+{
+    while(size > 0)
+    {
+        ssize_t written = ::write(fd, data, size);
+        if(written <= 0)
+            return false;
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+}
+
+AllocationResult::AllocationResult()
+    : allocations(0)
+    , lines(0)
+    , epochs(0)
+{
+}
+
+double AllocationResult::perLine() const
+{
+    return lines ? double(allocations) / lines : 0;
+}
+
+double AllocationResult::perEpoch() const
+{
+    return epochs ? double(allocations) / epochs : 0;
+}
+
+bool measureClientAllocations(const std::string& log, int warmUp, AllocationResult* result)
+{
+    uint16_t port = 0;
+    int server = listenOnLoopback(&port);
+    if(server < 0)
+        return false;
+    GpsdClient client(GpsdClient::NmeaMode);
+    bool opened = client.open("127.0.0.1", port);
+    int peer = opened ? accept(server, 0, 0) : -1;
+    ::close(server);
+    if(peer < 0)
+        return false;
+
+    // an epoch starts with its RMC sentence
+    CountingHandler handler;
+    size_t start = 0;
+    int epoch = 0;
+    bool ok = true;
+    while(ok && start < log.size())
+    {
+        size_t end = start;
+        int lines = 0;
+        do
+        {
+            size_t next = log.find('\n', end);
+            end = next == std::string::npos ? log.size() : next + 1;
+            ++lines;
+        } while(end < log.size()
+                && GpsdEpochAssembler::sentenceType(log.data() + end, int(log.size() - end))
+                   != GpsdEpochAssembler::RMC);
+        ok = writeAll(peer, log.data() + start, end - start);
+        start = end;
+
+        // on loopback, what was written is readable right away; the epoch
+        // is read back completely before the next one is sent
+        uint64_t before = GpsdAllocationCounter::count();
+        for(;;)
+        {
+            struct pollfd pfd;
+            pfd.fd = client.fd();
+            pfd.events = POLLIN;
+            int ready = poll(&pfd, 1, 10);
+            if(ready <= 0)
+                break;
+            if(client.dispatch(&handler) < 0)
+            {
+                ok = false;
+                break;
+            }
+        }
+        if(epoch++ >= warmUp)
+        {
+            result->allocations += GpsdAllocationCounter::count() - before;
+            result->lines += lines;
+            ++result->epochs;
+        }
+    }
+    ::close(peer);
+    client.close();
+    return ok && handler.fixes > 0;
+}
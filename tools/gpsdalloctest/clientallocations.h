@@ -0,0 +1,49 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CLIENTALLOCATIONS_H
+#define CLIENTALLOCATIONS_H
+
+#include <string>
+
+// Heap allocations of a measured stretch of a log
+struct AllocationResult
+{
+    AllocationResult();
+
+    long long allocations;
+    int lines;
+    int epochs;
+
+    double perLine() const;
+    double perEpoch() const;
+};
+
+// Serves the NMEA log epoch by epoch to a GpsdClient through a loopback
+// connection and counts the allocations of its dispatch() calls after the
+// first warmUp epochs. Returns false if the connection failed.
+bool measureClientAllocations(const std::string& log, int warmUp, AllocationResult* result);
+
+#endif // CLIENTALLOCATIONS_H
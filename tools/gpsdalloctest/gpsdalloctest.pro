@@ -0,0 +1,32 @@
+# Checks the heap allocations per line and per epoch of GpsdClient and of
+# the gpsd position plugin against the thresholds in thresholds.txt
+TARGET = gpsdalloctest
+QT = core positioning
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+# GpsdClient and the log replay of the core are built on POSIX only
+!unix: error("gpsdalloctest is available on POSIX systems only")
+
+include(../../core/gpsdcore.pri)
+
+INCLUDEPATH += ../common
+
+DEFINES += SOURCE_DIR=\\\"$$PWD\\\"
+
+HEADERS += \
+    ../common/gpsdallocationcounter.h \
+    clientallocations.h \
+    sourceallocations.h
+
+SOURCES += \
+    ../common/gpsdallocationcounter.cpp \
+    clientallocations.cpp \
+    sourceallocations.cpp \
+    main.cpp
+
+DISTFILES += \
+    drive.nmea \
+    thresholds.txt
@@ -0,0 +1,197 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "clientallocations.h"
+#include "gpsdallocationcounter.h"
+#include "gpsdepochassembler.h"
+#include "sourceallocations.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QMap>
+#include <QStringList>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+
+// "name value" per line, # starts a comment
+bool readThresholds(const QString& fileName, QMap<QString, double>* thresholds)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    while(!file.atEnd())
+    {
+        QString line = QString::fromUtf8(file.readLine()).section('#', 0, 0).simplified();
+        if(line.isEmpty())
+            continue;
+        bool ok = false;
+        double value = line.section(' ', 1, 1).toDouble(&ok);
+        if(!ok)
+            return false;
+        thresholds->insert(line.section(' ', 0, 0), value);
+    }
+    return true;
+}
+
+// the measured values with a tenth of headroom, rounded up; a path that
+// does not allocate stays at zero
+bool writeThresholds(const QString& fileName, const QMap<QString, double>& measured)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+    file.write("# Heap allocations allowed per line and per epoch of drive.nmea, checked by\n"
+               "# gpsdalloctest and written by gpsdalloctest --write-thresholds\n");
+    for(QMap<QString, double>::const_iterator it = measured.begin(); it != measured.end(); ++it)
+    {
+        double value = std::ceil(it.value() * 1.1 * 10) / 10;
+        file.write(QString("%1 %2\n").arg(it.key()).arg(value).toUtf8());
+    }
+    return true;
+}
+
+void addResult(QMap<QString, double>* measured, const QString& path, const AllocationResult& result)
+{
+    measured->insert(path + "_per_line", result.perLine());
+    measured->insert(path + "_per_epoch", result.perEpoch());
+}
+
+QByteArray resultJson(const AllocationResult& result)
+{
+    return QString("{\"epochs\":%1,\"lines\":%2,\"allocations\":%3,"
+                   "\"per_line\":%4,\"per_epoch\":%5}")
+        .arg(result.epochs).arg(result.lines).arg(result.allocations)
+        .arg(result.perLine(), 0, 'f', 2).arg(result.perEpoch(), 0, 'f', 2).toUtf8();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    // the replay is played from its start on a connection of its own
+    if(qEnvironmentVariableIsEmpty("GPSD_LINGER"))
+        qputenv("GPSD_LINGER", "0");
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gpsdalloctest");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks the heap allocations per line and per epoch of "
+                                     "GpsdClient and of the gpsd position plugin");
+    parser.addHelpOption();
+    QCommandLineOption log("log", "NMEA log to replay.", "file", SOURCE_DIR "/drive.nmea");
+    QCommandLineOption thresholds("thresholds", "Allowed allocations.", "file",
+                                  SOURCE_DIR "/thresholds.txt");
+    QCommandLineOption write("write-thresholds",
+                             "Write the measured values with some headroom as thresholds.");
+    QCommandLineOption warmUp("warm-up", "Epochs not counted at the start.", "epochs", "5");
+    parser.addOptions(QList<QCommandLineOption>() << log << thresholds << write << warmUp);
+    parser.process(app);
+
+    if(!GpsdAllocationCounter::isAvailable())
+    {
+        fprintf(stderr, "Counting allocations is not supported on this platform\n");
+        return 1;
+    }
+    QFile logFile(parser.value(log));
+    if(!logFile.open(QIODevice::ReadOnly))
+    {
+        fprintf(stderr, "Cannot read %s\n", qPrintable(parser.value(log)));
+        return 1;
+    }
+    QByteArray data = logFile.readAll();
+    int lines = data.count('\n');
+    int epochs = 0;
+    foreach(const QByteArray& line, data.split('\n'))
+    {
+        if(GpsdEpochAssembler::sentenceType(line.constData(), line.size()) == GpsdEpochAssembler::RMC)
+            ++epochs;
+    }
+    int warmUpEpochs = parser.value(warmUp).toInt();
+    if(epochs <= warmUpEpochs)
+    {
+        fprintf(stderr, "The log has no epochs after the warm-up\n");
+        return 1;
+    }
+
+    QMap<QString, double> measured;
+    AllocationResult client;
+    if(!measureClientAllocations(std::string(data.constData(), data.size()), warmUpEpochs, &client))
+    {
+        fprintf(stderr, "Replaying the log through GpsdClient failed\n");
+        return 1;
+    }
+    addResult(&measured, "client", client);
+
+    AllocationResult source;
+    SourceAllocations sourceAllocations(parser.value(log), qRound(double(lines) / epochs),
+                                        warmUpEpochs);
+    if(!sourceAllocations.measure(&source))
+    {
+        fprintf(stderr, "Replaying the log through the gpsd plugin failed\n");
+        return 1;
+    }
+    addResult(&measured, "source", source);
+
+    printf("{\"client\":%s,\"source\":%s}\n", resultJson(client).constData(),
+           resultJson(source).constData());
+
+    if(parser.isSet(write))
+    {
+        if(!writeThresholds(parser.value(thresholds), measured))
+        {
+            fprintf(stderr, "Cannot write %s\n", qPrintable(parser.value(thresholds)));
+            return 1;
+        }
+        return 0;
+    }
+
+    QMap<QString, double> allowed;
+    if(!readThresholds(parser.value(thresholds), &allowed))
+    {
+        fprintf(stderr, "Cannot read %s\n", qPrintable(parser.value(thresholds)));
+        return 1;
+    }
+    int exceeded = 0;
+    for(QMap<QString, double>::const_iterator it = measured.begin(); it != measured.end(); ++it)
+    {
+        if(!allowed.contains(it.key()))
+        {
+            fprintf(stderr, "No threshold for %s\n", qPrintable(it.key()));
+            ++exceeded;
+        }
+        else if(it.value() > allowed.value(it.key()))
+        {
+            fprintf(stderr, "%s: %.2f allocations, at most %.2f allowed\n", qPrintable(it.key()),
+                    it.value(), allowed.value(it.key()));
+            ++exceeded;
+        }
+    }
+    return exceeded ? 2 : 0;
+}
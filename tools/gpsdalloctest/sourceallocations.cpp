@@ -0,0 +1,110 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "sourceallocations.h"
+
+#include "gpsdallocationcounter.h"
+
+#include <QEventLoop>
+#include <QGeoPositionInfoSource>
+#include <QGeoSatelliteInfoSource>
+
+SourceAllocations::SourceAllocations(const QString& log, int linesPerEpoch, int warmUp,
+                                     QObject* parent)
+    : QObject(parent)
+    , _log(log)
+    , _linesPerEpoch(linesPerEpoch)
+    , _warmUp(warmUp)
+    , _epochs(0)
+    , _skies(0)
+    , _warmedUpAt(0)
+    , _lastUpdateAt(0)
+{
+    _idleTimer.setSingleShot(true);
+    _idleTimer.setInterval(1000);
+}
+
+bool SourceAllocations::measure(AllocationResult* result)
+{
+    QVariantMap parameters;
+    parameters.insert("gpsd.transport", "replay");
+    parameters.insert("gpsd.file", _log);
+    parameters.insert("gpsd.speed", "max");
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    QGeoPositionInfoSource* position = QGeoPositionInfoSource::createSource("gpsd", parameters, this);
+    QGeoSatelliteInfoSource* satellite = QGeoSatelliteInfoSource::createSource("gpsd", parameters, this);
+#else
+    QGeoPositionInfoSource* position = 0;
+    QGeoSatelliteInfoSource* satellite = 0;
+#endif
+    if(!position || !satellite)
+    {
+        delete position;
+        delete satellite;
+        return false;
+    }
+    connect(position, SIGNAL( positionUpdated(QGeoPositionInfo)),
+            this, SLOT( positionUpdated(QGeoPositionInfo)));
+    connect(satellite, SIGNAL( satellitesInViewUpdated(QList<QGeoSatelliteInfo>)),
+            this, SLOT( satellitesUpdated(QList<QGeoSatelliteInfo>)));
+
+    QEventLoop loop;
+    connect(&_idleTimer, SIGNAL( timeout()), &loop, SLOT( quit()));
+    QTimer::singleShot(30000, &loop, SLOT( quit()));
+    _idleTimer.start();
+    position->startUpdates();
+    satellite->startUpdates();
+    loop.exec();
+
+    delete position;
+    delete satellite;
+
+    if(_epochs <= _warmUp || _skies <= _warmUp)
+        return false;
+    result->allocations = static_cast<long long>(_lastUpdateAt - _warmedUpAt);
+    result->epochs = _epochs - _warmUp;
+    result->lines = result->epochs * _linesPerEpoch;
+    return true;
+}
+
+void SourceAllocations::positionUpdated(const QGeoPositionInfo& info)
+{
+    Q_UNUSED(info);
+    // all allocations of an epoch happen before the signal of its last
+    // sentence, so the window runs from update to update
+    quint64 count = GpsdAllocationCounter::count();
+    if(++_epochs == _warmUp)
+        _warmedUpAt = count;
+    _lastUpdateAt = count;
+    _idleTimer.start();
+}
+
+void SourceAllocations::satellitesUpdated(const QList<QGeoSatelliteInfo>& satellites)
+{
+    Q_UNUSED(satellites);
+    ++_skies;
+    _idleTimer.start();
+}
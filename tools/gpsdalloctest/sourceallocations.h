@@ -0,0 +1,70 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SOURCEALLOCATIONS_H
+#define SOURCEALLOCATIONS_H
+
+#include "clientallocations.h"
+
+#include <QElapsedTimer>
+#include <QGeoPositionInfo>
+#include <QGeoSatelliteInfo>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+class QEventLoop;
+
+// Replays the log at maximum speed through the master to a position and a
+// satellite source of the plugin and counts the allocations of the whole
+// process between the position update of the epoch warmUp and the last
+// one; the replay ends when no update has come for a second.
+class SourceAllocations : public QObject
+{
+    Q_OBJECT
+
+public:
+    SourceAllocations(const QString& log, int linesPerEpoch, int warmUp, QObject* parent = 0);
+
+    // Returns false if the plugin is not available or too few updates
+    // arrived.
+    bool measure(AllocationResult* result);
+
+private slots:
+    void positionUpdated(const QGeoPositionInfo& info);
+    void satellitesUpdated(const QList<QGeoSatelliteInfo>& satellites);
+
+private:
+    QString _log;
+    int _linesPerEpoch;
+    int _warmUp;
+    QTimer _idleTimer;
+    int _epochs;
+    int _skies;
+    quint64 _warmedUpAt;
+    quint64 _lastUpdateAt;
+};
+
+#endif // SOURCEALLOCATIONS_H
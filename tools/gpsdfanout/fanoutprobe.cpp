@@ -0,0 +1,103 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "fanoutprobe.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QGeoPositionInfoSource>
+#include <QTimer>
+#include <QVariant>
+
+FanoutProbe::FanoutProbe(const QVariantMap& parameters, int duration, QObject* parent)
+    : QObject(parent)
+    , _parameters(parameters)
+    , _duration(duration)
+    , _updates(0)
+{
+}
+
+QByteArray FanoutProbe::run(int sources, int paused)
+{
+    QList<QGeoPositionInfoSource*> created;
+    for(int i=0; i<sources; ++i)
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        QGeoPositionInfoSource* source = QGeoPositionInfoSource::createSource("gpsd", _parameters, this);
+#else
+        QGeoPositionInfoSource* source = QGeoPositionInfoSource::createSource("gpsd", this);
+#endif
+        if(!source)
+        {
+            qDeleteAll(created);
+            return QByteArray();
+        }
+        connect(source, SIGNAL( positionUpdated(QGeoPositionInfo)),
+                this, SLOT( positionUpdated(QGeoPositionInfo)));
+        source->startUpdates();
+        created.append(source);
+    }
+    // paused sources keep their slaves, which the master has to skip
+    for(int i=0; i<paused && i<created.size(); ++i)
+        created.at(i)->stopUpdates();
+
+    QObject* metrics = created.first()->property("metrics").value<QObject*>();
+    if(!metrics)
+    {
+        qDeleteAll(created);
+        return QByteArray();
+    }
+    metrics->setProperty("enabled", true);
+    QMetaObject::invokeMethod(metrics, "reset", Qt::DirectConnection);
+    _updates = 0;
+
+    QEventLoop loop;
+    QTimer::singleShot(_duration, &loop, SLOT( quit()));
+    QElapsedTimer clock;
+    clock.start();
+    loop.exec();
+    double seconds = clock.nsecsElapsed() / 1e9;
+
+    qint64 lines = metrics->property("linesReceived").toLongLong();
+    qint64 bytes = metrics->property("bytesReceived").toLongLong();
+    qint64 dropped = metrics->property("droppedBytes").toLongLong();
+    qint64 updates = _updates;
+    qDeleteAll(created);
+
+    return "{\"sources\":" + QByteArray::number(sources)
+            + ",\"paused\":" + QByteArray::number(paused)
+            + ",\"lines_per_second\":" + QByteArray::number(lines / seconds, 'f', 0)
+            + ",\"bytes_per_second\":" + QByteArray::number(bytes / seconds, 'f', 0)
+            + ",\"bytes_per_line\":" + QByteArray::number(lines ? double(bytes) / lines : 0, 'f', 1)
+            + ",\"updates_per_second\":" + QByteArray::number(updates / seconds, 'f', 0)
+            + ",\"dropped_bytes_per_second\":" + QByteArray::number(dropped / seconds, 'f', 0)
+            + "}";
+}
+
+void FanoutProbe::positionUpdated(const QGeoPositionInfo& info)
+{
+    Q_UNUSED(info);
+    ++_updates;
+}
@@ -0,0 +1,58 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef FANOUTPROBE_H
+#define FANOUTPROBE_H
+
+#include <QGeoPositionInfo>
+#include <QObject>
+#include <QVariantMap>
+
+// Runs steps of a fan-out benchmark: a number of position sources of one
+// connection, some of them paused, read as much as the connection
+// delivers for a while. The plugin's metrics tell how many lines and
+// bytes went through.
+class FanoutProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    FanoutProbe(const QVariantMap& parameters, int duration, QObject* parent = 0);
+
+    // One step with the given number of sources, of which paused ones
+    // have been started and stopped again. Returns the result as a JSON
+    // object, or nothing if the plugin is not available.
+    QByteArray run(int sources, int paused);
+
+private slots:
+    void positionUpdated(const QGeoPositionInfo& info);
+
+private:
+    QVariantMap _parameters;
+    int _duration;
+    qint64 _updates;
+};
+
+#endif // FANOUTPROBE_H
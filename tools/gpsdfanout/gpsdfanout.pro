@@ -0,0 +1,15 @@
+# Measures the throughput of the gpsd position plugin as sources are
+# added, fed by a replayed scenario
+TARGET = gpsdfanout
+QT = core positioning
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+HEADERS += \
+    fanoutprobe.h
+
+SOURCES += \
+    fanoutprobe.cpp \
+    main.cpp
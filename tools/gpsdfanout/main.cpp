@@ -0,0 +1,91 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "fanoutprobe.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QStringList>
+#include <cstdio>
+
+int main(int argc, char* argv[])
+{
+    // every step replays the scenario from its start on a new connection
+    if(qEnvironmentVariableIsEmpty("GPSD_LINGER"))
+        qputenv("GPSD_LINGER", "0");
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gpsdfanout");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the fan-out throughput of the gpsd position plugin");
+    parser.addHelpOption();
+    QCommandLineOption sources("sources", "Comma separated source counts.", "counts",
+                               "1,2,4,8,16,32,64");
+    QCommandLineOption paused("paused", "Comma separated fractions of paused sources.", "fractions",
+                              "0,0.5");
+    QCommandLineOption duration("duration", "Measuring time per step.", "seconds", "5");
+    QCommandLineOption satellites("satellites", "Satellites in view of the scenario.", "count", "40");
+    QCommandLineOption parameter("parameter", "Further source parameter; repeatable.", "name=value");
+    parser.addOptions(QList<QCommandLineOption>() << sources << paused << duration << satellites
+                      << parameter);
+    parser.process(app);
+
+    // a synthetic scenario replayed without delays, so that the plugin and
+    // not the feed sets the pace; no network is involved
+    QVariantMap parameters;
+    parameters.insert("gpsd.transport", "replay");
+    parameters.insert("gpsd.scenario", "1");
+    parameters.insert("gpsd.rate", "10");
+    parameters.insert("gpsd.speed", "max");
+    parameters.insert("gpsd.satellites", parser.value(satellites));
+    foreach(const QString& option, parser.values(parameter))
+        parameters.insert(option.section('=', 0, 0), option.section('=', 1));
+
+    FanoutProbe probe(parameters, parser.value(duration).toInt() * 1000);
+    QByteArray report = "{\"steps\":[";
+    bool first = true;
+    foreach(const QString& count, parser.value(sources).split(','))
+    {
+        foreach(const QString& fraction, parser.value(paused).split(','))
+        {
+            if(count.isEmpty() || fraction.isEmpty())
+                continue;
+            // at least one source keeps the connection busy
+            int total = qMax(count.toInt(), 1);
+            int pausedCount = qMin(int(total * fraction.toDouble()), total - 1);
+            QByteArray step = probe.run(total, pausedCount);
+            if(step.isEmpty())
+            {
+                fprintf(stderr, "The gpsd position plugin is not available\n");
+                return 1;
+            }
+            report += (first ? "" : ",") + step;
+            first = false;
+        }
+    }
+    printf("%s]}\n", report.constData());
+    return 0;
+}
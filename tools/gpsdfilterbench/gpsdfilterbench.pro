@@ -0,0 +1,19 @@
+# Measures the time the Kalman filter of the position source takes per
+# update, fed by a synthetic scenario
+TARGET = gpsdfilterbench
+QT = core positioning
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+include(../../core/gpsdcore.pri)
+
+INCLUDEPATH += ../..
+
+HEADERS += \
+    ../../gpsdkalmanfilter.h
+
+SOURCES += \
+    ../../gpsdkalmanfilter.cpp \
+    main.cpp
@@ -0,0 +1,131 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdkalmanfilter.h"
+#include "gpsdscenario.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+#include <algorithm>
+#include <cstdio>
+#include <qnumeric.h>
+
+namespace
+{
+
+void setAttribute(QGeoPositionInfo* info, QGeoPositionInfo::Attribute attribute, double value)
+{
+    if(!qIsNaN(value))
+        info->setAttribute(attribute, value);
+}
+
+// as the position source converts its epochs
+QGeoPositionInfo toPositionInfo(const GpsdFix& fix, qint64 time)
+{
+    QGeoCoordinate coordinate(fix.latitude, fix.longitude);
+    if(fix.hasAltitude())
+        coordinate.setAltitude(fix.altitude);
+    QGeoPositionInfo info(coordinate, QDateTime::fromMSecsSinceEpoch(time, Qt::UTC));
+    setAttribute(&info, QGeoPositionInfo::Direction, fix.course);
+    setAttribute(&info, QGeoPositionInfo::GroundSpeed, fix.speed);
+    setAttribute(&info, QGeoPositionInfo::VerticalSpeed, fix.climb);
+    setAttribute(&info, QGeoPositionInfo::HorizontalAccuracy, fix.horizontalAccuracy);
+    setAttribute(&info, QGeoPositionInfo::VerticalAccuracy, fix.verticalAccuracy);
+    return info;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gpsdfilterbench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the Kalman filter of the gpsd position plugin");
+    parser.addHelpOption();
+    QCommandLineOption epochs("epochs", "Updates to filter.", "count", "100000");
+    QCommandLineOption rate("rate", "Epochs per second of the stream.", "hz", "25");
+    QCommandLineOption noise("process-noise", "Acceleration noise in m^2/s^3.", "noise", "1");
+    QCommandLineOption seed("seed", "Seed of the scenario.", "seed", "1");
+    QCommandLineOption maxP99("max-p99", "Fail if the p99 per update exceeds this.", "ns");
+    parser.addOptions(QList<QCommandLineOption>() << epochs << rate << noise << seed << maxP99);
+    parser.process(app);
+
+    GpsdScenario::Options options;
+    options.seed = parser.value(seed).toUInt();
+    options.rate = qMax(parser.value(rate).toDouble(), 0.01);
+    GpsdScenario scenario(options);
+
+    // the fixes are converted up front, only the filter is timed
+    int count = qMax(parser.value(epochs).toInt(), 1);
+    QVector<QGeoPositionInfo> fixes;
+    QVector<qint64> receivedAt;
+    fixes.reserve(count);
+    receivedAt.reserve(count);
+    for(int i=0; i<count; ++i)
+    {
+        scenario.next();
+        fixes.append(toPositionInfo(scenario.fix(), scenario.time()));
+        receivedAt.append(scenario.elapsed());
+    }
+
+    GpsdKalmanFilter filter;
+    filter.setProcessNoise(parser.value(noise).toDouble());
+    QVector<qint64> times;
+    times.reserve(count);
+    double latitude = 0;
+    QElapsedTimer clock;
+    clock.start();
+    qint64 total = clock.nsecsElapsed();
+    for(int i=0; i<count; ++i)
+    {
+        qint64 start = clock.nsecsElapsed();
+        QGeoPositionInfo filtered = filter.filter(fixes.at(i), receivedAt.at(i));
+        times.append(clock.nsecsElapsed() - start);
+        latitude += filtered.coordinate().latitude();
+    }
+    total = clock.nsecsElapsed() - total;
+
+    std::sort(times.begin(), times.end());
+    qint64 p99 = times.at((times.size() - 1) * 99 / 100);
+    printf("{\"updates\":%d,\"mean\":%lld,\"p50\":%lld,\"p99\":%lld,\"max\":%lld,\"unit\":\"ns\"}\n",
+           count, static_cast<long long>(total / count),
+           static_cast<long long>(times.at(times.size() / 2)),
+           static_cast<long long>(p99), static_cast<long long>(times.last()));
+
+    // keeps the filtered results alive
+    if(qIsNaN(latitude))
+        return 1;
+    if(parser.isSet(maxP99) && p99 > parser.value(maxP99).toLongLong())
+    {
+        fprintf(stderr, "p99 of %lld ns exceeds %s ns\n",
+                static_cast<long long>(p99), parser.value(maxP99).toLatin1().constData());
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,17 @@
+#!/bin/sh
+# Checks the latency target of the high-rate mode: a p99 below 5 ms from
+# socket read to positionUpdated() at 25 Hz, against a local fakegpsd.
+# Expects fakegpsd and gpsdlatency to be built; pass their directory if
+# they are not in the current one.
+
+BIN=${1:-.}
+PORT=${PORT:-2948}
+MAX_P99=${MAX_P99:-5000000}
+
+"$BIN/fakegpsd" --port "$PORT" --rate 25 --satellites 40 &
+FAKEGPSD=$!
+trap 'kill $FAKEGPSD 2>/dev/null' EXIT
+sleep 1
+
+"$BIN/gpsdlatency" --parameter gpsd.port="$PORT" --parameter gpsd.high_rate=true \
+    --sources 4 --satellite-sources 1 --duration 30 --max-p99 "$MAX_P99"
@@ -0,0 +1,18 @@
+# Measures the delivery latency of the gpsd position plugin, e.g. fed by
+# fakegpsd
+TARGET = gpsdlatency
+QT = core positioning
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+HEADERS += \
+    latencyprobe.h
+
+SOURCES += \
+    latencyprobe.cpp \
+    main.cpp
+
+DISTFILES += \
+    check-high-rate.sh
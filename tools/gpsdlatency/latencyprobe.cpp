@@ -0,0 +1,122 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "latencyprobe.h"
+
+#include <QDateTime>
+#include <QGeoPositionInfoSource>
+#include <QGeoSatelliteInfoSource>
+#include <QVariant>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <time.h>
+#endif
+
+namespace
+{
+
+qint64 monotonicNsecs()
+{
+#ifdef Q_OS_UNIX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+qint64 p99(QVector<qint64> values)
+{
+    if(values.isEmpty())
+        return -1;
+    std::sort(values.begin(), values.end());
+    return values.at((values.size() - 1) * 99 / 100);
+}
+
+QByteArray percentiles(const char* name, QVector<qint64> values, const char* unit)
+{
+    QByteArray result = QByteArray("\"") + name + "\":{\"count\":" + QByteArray::number(values.size());
+    if(!values.isEmpty())
+    {
+        std::sort(values.begin(), values.end());
+        result += ",\"p50\":" + QByteArray::number(values.at(values.size() / 2))
+                + ",\"p99\":" + QByteArray::number(p99(values))
+                + ",\"max\":" + QByteArray::number(values.last());
+    }
+    return result + ",\"unit\":\"" + unit + "\"}";
+}
+
+}
+
+LatencyProbe::LatencyProbe(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void LatencyProbe::addSource(QGeoPositionInfoSource* source)
+{
+    connect(source, SIGNAL( positionUpdated(QGeoPositionInfo)),
+            this, SLOT( positionUpdated(QGeoPositionInfo)));
+}
+
+void LatencyProbe::addSource(QGeoSatelliteInfoSource* source)
+{
+    connect(source, SIGNAL( satellitesInViewUpdated(QList<QGeoSatelliteInfo>)),
+            this, SLOT( satellitesUpdated(QList<QGeoSatelliteInfo>)));
+}
+
+QByteArray LatencyProbe::report() const
+{
+    return "{" + percentiles("position_read", _positionRead, "ns") + ","
+            + percentiles("position_write", _positionWrite, "ms") + ","
+            + percentiles("satellite_read", _satelliteRead, "ns") + "}";
+}
+
+qint64 LatencyProbe::positionReadP99() const
+{
+    return p99(_positionRead);
+}
+
+void LatencyProbe::positionUpdated(const QGeoPositionInfo& info)
+{
+    addReadLatency(sender(), &_positionRead);
+    if(info.timestamp().isValid())
+        _positionWrite.append(info.timestamp().msecsTo(QDateTime::currentDateTimeUtc()));
+}
+
+void LatencyProbe::satellitesUpdated(const QList<QGeoSatelliteInfo>& satellites)
+{
+    Q_UNUSED(satellites);
+    addReadLatency(sender(), &_satelliteRead);
+}
+
+void LatencyProbe::addReadLatency(QObject* source, QVector<qint64>* latencies)
+{
+    qint64 receivedAt = source->property("lastUpdateReceivedAt").toLongLong();
+    if(receivedAt > 0)
+        latencies->append(monotonicNsecs() - receivedAt);
+}
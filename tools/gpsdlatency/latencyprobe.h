@@ -0,0 +1,73 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef LATENCYPROBE_H
+#define LATENCYPROBE_H
+
+#include <QGeoPositionInfo>
+#include <QGeoSatelliteInfo>
+#include <QList>
+#include <QObject>
+#include <QVector>
+
+class QGeoPositionInfoSource;
+class QGeoSatelliteInfoSource;
+
+// Collects the latencies of the updates of position and satellite sources
+// of the gpsd plugin:
+//
+//   read     from the plugin reading the data from the gpsd socket to the
+//            signal, from the lastUpdateReceivedAt property, in ns
+//   write    from the fix time to positionUpdated(), in ms; with fakegpsd
+//            on the same host, the fix time is the time it wrote the epoch
+class LatencyProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LatencyProbe(QObject* parent = 0);
+
+    void addSource(QGeoPositionInfoSource* source);
+    void addSource(QGeoSatelliteInfoSource* source);
+
+    // p50, p99 and maximum of each latency as one JSON object
+    QByteArray report() const;
+
+    // p99 of the position read latency in ns, -1 without updates
+    qint64 positionReadP99() const;
+
+private slots:
+    void positionUpdated(const QGeoPositionInfo& info);
+    void satellitesUpdated(const QList<QGeoSatelliteInfo>& satellites);
+
+private:
+    void addReadLatency(QObject* source, QVector<qint64>* latencies);
+
+    QVector<qint64> _positionRead;
+    QVector<qint64> _positionWrite;
+    QVector<qint64> _satelliteRead;
+};
+
+#endif // LATENCYPROBE_H
@@ -0,0 +1,135 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "latencyprobe.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QGeoPositionInfoSource>
+#include <QGeoSatelliteInfoSource>
+#include <QTimer>
+#include <cstdio>
+
+namespace
+{
+
+// all sources of the plugin hand out the same metrics object
+QObject* enableMetrics(QObject* source)
+{
+    QObject* metrics = source->property("metrics").value<QObject*>();
+    if(metrics)
+        metrics->setProperty("enabled", true);
+    return metrics;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gpsdlatency");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the update latency of the gpsd position plugin");
+    parser.addHelpOption();
+    QCommandLineOption sources("sources", "Position sources to create.", "count", "1");
+    QCommandLineOption satellites("satellite-sources", "Satellite sources to create.", "count", "0");
+    QCommandLineOption duration("duration", "Measuring time.", "seconds", "10");
+    QCommandLineOption parameter("parameter", "Source parameter, e.g. gpsd.port=2948; repeatable.",
+                                 "name=value");
+    QCommandLineOption metrics("metrics", "Also print the plugin's metrics as JSON.");
+    QCommandLineOption maxP99("max-p99", "Fail if the p99 of position_read exceeds this.", "ns");
+    parser.addOptions(QList<QCommandLineOption>() << sources << satellites << duration << parameter
+                      << metrics << maxP99);
+    parser.process(app);
+
+    QVariantMap parameters;
+    foreach(const QString& option, parser.values(parameter))
+        parameters.insert(option.section('=', 0, 0), option.section('=', 1));
+
+    LatencyProbe probe;
+    QObject* pluginMetrics = 0;
+    for(int i=0; i<parser.value(sources).toInt(); ++i)
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        QGeoPositionInfoSource* source = QGeoPositionInfoSource::createSource("gpsd", parameters, &app);
+#else
+        QGeoPositionInfoSource* source = QGeoPositionInfoSource::createSource("gpsd", &app);
+#endif
+        if(!source)
+        {
+            fprintf(stderr, "The gpsd position plugin is not available\n");
+            return 1;
+        }
+        probe.addSource(source);
+        if(parser.isSet(metrics) && !pluginMetrics)
+            pluginMetrics = enableMetrics(source);
+        source->startUpdates();
+    }
+    for(int i=0; i<parser.value(satellites).toInt(); ++i)
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        QGeoSatelliteInfoSource* source = QGeoSatelliteInfoSource::createSource("gpsd", parameters, &app);
+#else
+        QGeoSatelliteInfoSource* source = QGeoSatelliteInfoSource::createSource("gpsd", &app);
+#endif
+        if(!source)
+        {
+            fprintf(stderr, "The gpsd position plugin is not available\n");
+            return 1;
+        }
+        probe.addSource(source);
+        if(parser.isSet(metrics) && !pluginMetrics)
+            pluginMetrics = enableMetrics(source);
+        source->startUpdates();
+    }
+
+    QTimer::singleShot(parser.value(duration).toInt() * 1000, &app, SLOT( quit()));
+    app.exec();
+    printf("%s\n", probe.report().constData());
+    if(pluginMetrics)
+    {
+        QByteArray dump;
+        QMetaObject::invokeMethod(pluginMetrics, "dump", Qt::DirectConnection,
+                                  Q_RETURN_ARG(QByteArray, dump));
+        printf("%s\n", dump.constData());
+    }
+    if(parser.isSet(maxP99))
+    {
+        qint64 p99 = probe.positionReadP99();
+        if(p99 < 0)
+        {
+            fprintf(stderr, "No position updates\n");
+            return 2;
+        }
+        if(p99 > parser.value(maxP99).toLongLong())
+        {
+            fprintf(stderr, "position_read p99 of %lld ns exceeds %s ns\n",
+                    static_cast<long long>(p99), parser.value(maxP99).toLatin1().constData());
+            return 2;
+        }
+    }
+    return 0;
+}
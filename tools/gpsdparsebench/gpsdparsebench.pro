@@ -0,0 +1,24 @@
+# Measures time and allocations per sentence of the NMEA and JSON decoders
+# of the core on the corpus in corpus/
+TARGET = gpsdparsebench
+CONFIG -= qt app_bundle
+CONFIG += console c++11
+
+TEMPLATE = app
+
+include(../../core/gpsdcore.pri)
+
+INCLUDEPATH += ../common
+
+HEADERS += \
+    ../common/gpsdallocationcounter.h
+
+SOURCES += \
+    ../common/gpsdallocationcounter.cpp \
+    main.cpp
+
+DISTFILES += \
+    corpus/damaged.nmea \
+    corpus/gps.nmea \
+    corpus/multi.json \
+    corpus/multi.nmea
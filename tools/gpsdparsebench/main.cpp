@@ -0,0 +1,266 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gpsdallocationcounter.h"
+#include "gpsdepochassembler.h"
+#include "gpsdjson.h"
+#include "gpsdnmea.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct Line
+{
+    const char* data;
+    int size;
+};
+
+typedef bool (*SelectorT)(const Line& line);
+typedef bool (*DecoderT)(const Line& line);
+
+bool anyLine(const Line&)
+{
+    return true;
+}
+
+bool positionLine(const Line& line)
+{
+    return GpsdEpochAssembler::sentenceType(line.data, line.size) != GpsdEpochAssembler::UnknownSentence;
+}
+
+bool gsvLine(const Line& line)
+{
+    return GpsdNmea::isSentence(line.data, line.size, "GSV");
+}
+
+bool gsaLine(const Line& line)
+{
+    return GpsdNmea::isSentence(line.data, line.size, "GSA");
+}
+
+bool tpvLine(const Line& line)
+{
+    return GpsdJson::isClass(line.data, line.size, "TPV");
+}
+
+bool skyLine(const Line& line)
+{
+    return GpsdJson::isClass(line.data, line.size, "SKY");
+}
+
+bool hasValidChecksum(const Line& line)
+{
+    return GpsdNmea::hasValidChecksum(line.data, line.size);
+}
+
+bool decodePosition(const Line& line)
+{
+    GpsdFix fix;
+    return GpsdNmea::decodePosition(line.data, line.size, &fix);
+}
+
+bool decodeGSV(const Line& line)
+{
+    GpsdNmea::Gsv gsv;
+    return GpsdNmea::decodeGSV(line.data, line.size, &gsv);
+}
+
+bool decodeGSA(const Line& line)
+{
+    GpsdNmea::Gsa gsa;
+    return GpsdNmea::decodeGSA(line.data, line.size, &gsa);
+}
+
+bool decodeTPV(const Line& line)
+{
+    GpsdFix fix;
+    return GpsdJson::decodeTPV(line.data, line.size, &fix);
+}
+
+bool decodeSKY(const Line& line)
+{
+    GpsdSky sky;
+    return GpsdJson::decodeSKY(line.data, line.size, &sky);
+}
+
+struct Benchmark
+{
+    const char* name;
+    SelectorT selector;
+    DecoderT decoder;
+};
+
+const Benchmark NmeaBenchmarks[] = {
+    { "hasValidChecksum", anyLine, hasValidChecksum },
+    { "decodePosition", positionLine, decodePosition },
+    { "decodeGSV", gsvLine, decodeGSV },
+    { "decodeGSA", gsaLine, decodeGSA }
+};
+
+const Benchmark JsonBenchmarks[] = {
+    { "decodeTPV", tpvLine, decodeTPV },
+    { "decodeSKY", skyLine, decodeSKY }
+};
+
+bool readFile(const char* path, std::string* contents)
+{
+    FILE* file = fopen(path, "rb");
+    if(!file)
+        return false;
+    char buffer[4096];
+    size_t got;
+    while((got = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        contents->append(buffer, got);
+    fclose(file);
+    return true;
+}
+
+std::vector<Line> splitLines(const std::string& contents)
+{
+    std::vector<Line> lines;
+    size_t start = 0;
+    while(start < contents.size())
+    {
+        size_t end = contents.find('\n', start);
+        end = end == std::string::npos ? contents.size() : end + 1;
+        Line line = { contents.data() + start, int(end - start) };
+        lines.push_back(line);
+        start = end;
+    }
+    return lines;
+}
+
+// Runs the decoder over the selected lines until minTime has passed and
+// appends ns and allocations per sentence as a JSON object.
+void run(const Benchmark& benchmark, const std::vector<Line>& lines, int minTime, std::string* out)
+{
+    // damaged lines are selected as well, as long as their type is known
+    std::vector<Line> selected;
+    int decoded = 0;
+    for(size_t i=0; i<lines.size(); ++i)
+    {
+        if(!benchmark.selector(lines[i]))
+            continue;
+        selected.push_back(lines[i]);
+        decoded += benchmark.decoder(lines[i]) ? 1 : 0;
+    }
+
+    typedef std::chrono::steady_clock ClockT;
+    long long sentences = 0;
+    long long sink = 0;
+    uint64_t allocations = GpsdAllocationCounter::count();
+    ClockT::time_point start = ClockT::now();
+    ClockT::time_point end = start;
+    while(!selected.empty() && end - start < std::chrono::milliseconds(minTime))
+    {
+        for(size_t i=0; i<selected.size(); ++i)
+            sink += benchmark.decoder(selected[i]) ? 1 : 0;
+        sentences += selected.size();
+        end = ClockT::now();
+    }
+    allocations = GpsdAllocationCounter::count() - allocations;
+    double nsecs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+    char result[256];
+    snprintf(result, sizeof(result),
+             "{\"name\":\"%s\",\"sentences\":%d,\"decoded\":%d,\"ns_per_sentence\":%.1f,"
+             "\"allocations_per_sentence\":%.3f}",
+             benchmark.name, int(selected.size()), decoded,
+             sentences ? nsecs / sentences : 0.0,
+             sentences ? double(allocations) / sentences : 0.0);
+    *out += result;
+
+    // keeps the decoding from being optimized away
+    if(sink < 0)
+        abort();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    int minTime = 200;
+    std::vector<const char*> paths;
+    for(int i=1; i<argc; ++i)
+    {
+        if(strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+            minTime = atoi(argv[++i]);
+        else if(argv[i][0] == '-')
+        {
+            fprintf(stderr, "Usage: %s [--min-time ms] corpus...\n"
+                            "Files ending in .json hold gpsd reports, others NMEA sentences.\n",
+                    argv[0]);
+            return 1;
+        }
+        else
+            paths.push_back(argv[i]);
+    }
+    if(paths.empty())
+    {
+        fprintf(stderr, "No corpus given, e.g. %s tools/gpsdparsebench/corpus/*\n", argv[0]);
+        return 1;
+    }
+
+    std::string out = GpsdAllocationCounter::isAvailable() ? "{\"allocations_counted\":true,\"corpora\":["
+                                                           : "{\"allocations_counted\":false,\"corpora\":[";
+    for(size_t i=0; i<paths.size(); ++i)
+    {
+        std::string contents;
+        if(!readFile(paths[i], &contents))
+        {
+            fprintf(stderr, "Cannot read %s\n", paths[i]);
+            return 1;
+        }
+        std::vector<Line> lines = splitLines(contents);
+        const char* name = strrchr(paths[i], '/');
+        name = name ? name + 1 : paths[i];
+        size_t nameSize = strlen(name);
+        bool json = nameSize > 5 && strcmp(name + nameSize - 5, ".json") == 0;
+
+        out += i ? ",{\"name\":\"" : "{\"name\":\"";
+        out += name;
+        out += "\",\"lines\":" + std::to_string(lines.size()) + ",\"functions\":[";
+        const Benchmark* benchmarks = json ? JsonBenchmarks : NmeaBenchmarks;
+        int count = json ? int(sizeof(JsonBenchmarks) / sizeof(Benchmark))
+                         : int(sizeof(NmeaBenchmarks) / sizeof(Benchmark));
+        for(int j=0; j<count; ++j)
+        {
+            if(j)
+                out += ",";
+            run(benchmarks[j], lines, minTime, &out);
+        }
+        out += "]}";
+    }
+    out += "]}";
+    printf("%s\n", out.c_str());
+    return 0;
+}
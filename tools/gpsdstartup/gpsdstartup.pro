@@ -0,0 +1,15 @@
+# Measures how long the gpsd position plugin takes to create sources and
+# to deliver their first updates, e.g. fed by fakegpsd
+TARGET = gpsdstartup
+QT = core positioning
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+HEADERS += \
+    startupprobe.h
+
+SOURCES += \
+    main.cpp \
+    startupprobe.cpp
@@ -0,0 +1,67 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "startupprobe.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <cstdio>
+
+int main(int argc, char* argv[])
+{
+    // every run has to connect anew instead of finding the connection of
+    // the run before still open
+    if(qEnvironmentVariableIsEmpty("GPSD_LINGER"))
+        qputenv("GPSD_LINGER", "0");
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gpsdstartup");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the startup time of the gpsd position plugin");
+    parser.addHelpOption();
+    QCommandLineOption runs("runs", "Starts to measure.", "count", "10");
+    QCommandLineOption timeout("timeout", "Time to wait for the first updates.", "ms", "5000");
+    QCommandLineOption parameter("parameter", "Source parameter, e.g. gpsd.port=2948; repeatable.",
+                                 "name=value");
+    parser.addOptions(QList<QCommandLineOption>() << runs << timeout << parameter);
+    parser.process(app);
+
+    QVariantMap parameters;
+    foreach(const QString& option, parser.values(parameter))
+        parameters.insert(option.section('=', 0, 0), option.section('=', 1));
+
+    StartupProbe probe(parameters, parser.value(timeout).toInt());
+    for(int i=0; i<parser.value(runs).toInt(); ++i)
+    {
+        if(!probe.run())
+        {
+            fprintf(stderr, "The gpsd position plugin is not available\n");
+            return 1;
+        }
+    }
+    printf("%s\n", probe.report().constData());
+    return 0;
+}
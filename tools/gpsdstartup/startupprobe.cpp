@@ -0,0 +1,157 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "startupprobe.h"
+
+#include <QEventLoop>
+#include <QGeoPositionInfoSource>
+#include <QGeoSatelliteInfoSource>
+#include <QTimer>
+#include <algorithm>
+
+namespace
+{
+
+QByteArray percentiles(const char* name, QVector<qint64> values)
+{
+    QByteArray result = QByteArray("\"") + name + "\":{\"count\":" + QByteArray::number(values.size());
+    if(!values.isEmpty())
+    {
+        std::sort(values.begin(), values.end());
+        result += ",\"p50\":" + QByteArray::number(values.at(values.size() / 2))
+                + ",\"max\":" + QByteArray::number(values.last());
+    }
+    return result + ",\"unit\":\"ns\"}";
+}
+
+}
+
+StartupProbe::StartupProbe(const QVariantMap& parameters, int timeout, QObject* parent)
+    : QObject(parent)
+    , _parameters(parameters)
+    , _timeout(timeout)
+    , _loop(0)
+    , _startedAt(0)
+    , _firstFix(-1)
+    , _firstSky(-1)
+    , _timeouts(0)
+{
+    _clock.start();
+}
+
+bool StartupProbe::run()
+{
+    qint64 start = _clock.nsecsElapsed();
+    bool available = QGeoPositionInfoSource::availableSources().contains("gpsd");
+    _availableSources.append(_clock.nsecsElapsed() - start);
+    if(!available)
+        return false;
+
+    start = _clock.nsecsElapsed();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    QGeoPositionInfoSource* position = QGeoPositionInfoSource::createSource("gpsd", _parameters, this);
+#else
+    QGeoPositionInfoSource* position = QGeoPositionInfoSource::createSource("gpsd", this);
+#endif
+    _createPosition.append(_clock.nsecsElapsed() - start);
+
+    start = _clock.nsecsElapsed();
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    QGeoSatelliteInfoSource* satellite = QGeoSatelliteInfoSource::createSource("gpsd", _parameters, this);
+#else
+    QGeoSatelliteInfoSource* satellite = QGeoSatelliteInfoSource::createSource("gpsd", this);
+#endif
+    _createSatellite.append(_clock.nsecsElapsed() - start);
+    if(!position || !satellite)
+    {
+        delete position;
+        delete satellite;
+        return false;
+    }
+
+    connect(position, SIGNAL( positionUpdated(QGeoPositionInfo)),
+            this, SLOT( positionUpdated(QGeoPositionInfo)));
+    connect(satellite, SIGNAL( satellitesInViewUpdated(QList<QGeoSatelliteInfo>)),
+            this, SLOT( satellitesUpdated(QList<QGeoSatelliteInfo>)));
+
+    _firstFix = -1;
+    _firstSky = -1;
+    QEventLoop loop;
+    _loop = &loop;
+    QTimer timer;
+    timer.setSingleShot(true);
+    connect(&timer, SIGNAL( timeout()), &loop, SLOT( quit()));
+    timer.start(_timeout);
+    _startedAt = _clock.nsecsElapsed();
+    position->startUpdates();
+    satellite->startUpdates();
+    loop.exec();
+    _loop = 0;
+
+    if(_firstFix >= 0 && _firstSky >= 0)
+    {
+        _firstFixes.append(_firstFix);
+        _firstSkies.append(_firstSky);
+    }
+    else
+        ++_timeouts;
+
+    // the connection closes with the last source, given GPSD_LINGER=0
+    delete position;
+    delete satellite;
+    return true;
+}
+
+QByteArray StartupProbe::report() const
+{
+    return "{" + percentiles("available_sources", _availableSources) + ","
+            + percentiles("create_position", _createPosition) + ","
+            + percentiles("create_satellite", _createSatellite) + ","
+            + percentiles("first_fix", _firstFixes) + ","
+            + percentiles("first_sky", _firstSkies) + ","
+            + "\"timeouts\":" + QByteArray::number(_timeouts) + "}";
+}
+
+void StartupProbe::positionUpdated(const QGeoPositionInfo& info)
+{
+    Q_UNUSED(info);
+    if(_firstFix < 0)
+        _firstFix = _clock.nsecsElapsed() - _startedAt;
+    finishIfDone();
+}
+
+void StartupProbe::satellitesUpdated(const QList<QGeoSatelliteInfo>& satellites)
+{
+    Q_UNUSED(satellites);
+    if(_firstSky < 0)
+        _firstSky = _clock.nsecsElapsed() - _startedAt;
+    finishIfDone();
+}
+
+void StartupProbe::finishIfDone()
+{
+    if(_loop && _firstFix >= 0 && _firstSky >= 0)
+        _loop->quit();
+}
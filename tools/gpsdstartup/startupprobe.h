@@ -0,0 +1,88 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef STARTUPPROBE_H
+#define STARTUPPROBE_H
+
+#include <QElapsedTimer>
+#include <QGeoPositionInfo>
+#include <QGeoSatelliteInfo>
+#include <QList>
+#include <QObject>
+#include <QVariantMap>
+#include <QVector>
+
+class QEventLoop;
+
+// Starts the gpsd plugin from scratch and measures, in ns:
+//
+//   available_sources   QGeoPositionInfoSource::availableSources()
+//   create_position     creating a position source
+//   create_satellite    creating a satellite source
+//   first_fix           from startUpdates() to the first positionUpdated()
+//   first_sky           from startUpdates() to the first
+//                       satellitesInViewUpdated()
+//
+// Creating a source does not connect to gpsd, so the first three stay far
+// below the connect time, which the last two include.
+class StartupProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    StartupProbe(const QVariantMap& parameters, int timeout, QObject* parent = 0);
+
+    // One start with new sources, which are destroyed afterwards. Returns
+    // false if the plugin is not available.
+    bool run();
+
+    // p50 and maximum of each time and the number of runs in which an
+    // update did not arrive within the timeout, as one JSON object
+    QByteArray report() const;
+
+private slots:
+    void positionUpdated(const QGeoPositionInfo& info);
+    void satellitesUpdated(const QList<QGeoSatelliteInfo>& satellites);
+
+private:
+    void finishIfDone();
+
+    QVariantMap _parameters;
+    int _timeout;
+    QElapsedTimer _clock;
+    QEventLoop* _loop;
+    qint64 _startedAt;
+    qint64 _firstFix;
+    qint64 _firstSky;
+
+    QVector<qint64> _availableSources;
+    QVector<qint64> _createPosition;
+    QVector<qint64> _createSatellite;
+    QVector<qint64> _firstFixes;
+    QVector<qint64> _firstSkies;
+    int _timeouts;
+};
+
+#endif // STARTUPPROBE_H
@@ -0,0 +1,15 @@
+# Creates, starts, stops and destroys sources of the gpsd position plugin
+# from several threads at once
+TARGET = gpsdstress
+QT = core positioning
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+HEADERS += \
+    stressworker.h
+
+SOURCES += \
+    main.cpp \
+    stressworker.cpp
@@ -0,0 +1,116 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "stressworker.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QThread>
+#include <QTimer>
+#include <cstdio>
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("gpsdstress");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Stresses the gpsd position plugin with sources in many threads");
+    parser.addHelpOption();
+    QCommandLineOption threads("threads", "Worker threads.", "count", "8");
+    QCommandLineOption duration("duration", "Stress time.", "seconds", "30");
+    QCommandLineOption seed("seed", "Seed of the random actions.", "seed", "1");
+    QCommandLineOption parameter("parameter", "Source parameter, e.g. gpsd.port=2948; repeatable.",
+                                 "name=value");
+    parser.addOptions(QList<QCommandLineOption>() << threads << duration << seed << parameter);
+    parser.process(app);
+
+    QVariantMap parameters;
+    foreach(const QString& option, parser.values(parameter))
+        parameters.insert(option.section('=', 0, 0), option.section('=', 1));
+
+    // the main thread keeps running its event loop, which the masters
+    // live in, until every worker has destroyed its sources; only then it
+    // waits for the threads
+    int millis = parser.value(duration).toInt() * 1000;
+    QList<QThread*> workerThreads;
+    QList<StressWorker*> workers;
+    for(int i=0; i<qMax(parser.value(threads).toInt(), 1); ++i)
+    {
+        QThread* thread = new QThread;
+        StressWorker* worker = new StressWorker(parameters, millis, parser.value(seed).toUInt() + i);
+        worker->moveToThread(thread);
+        QObject::connect(thread, SIGNAL( started()), worker, SLOT( start()));
+        QObject::connect(worker, SIGNAL( finished()), thread, SLOT( quit()));
+        workerThreads.append(thread);
+        workers.append(worker);
+    }
+
+    // a worker stuck in a blocking call into the main thread never
+    // finishes; give up on it well after the stress time
+    QTimer watchdog;
+    watchdog.setSingleShot(true);
+    QObject::connect(&watchdog, SIGNAL( timeout()), &app, SLOT( quit()));
+    watchdog.start(millis + 30000);
+
+    QTimer poll;
+    poll.setSingleShot(true);
+    QObject::connect(&poll, SIGNAL( timeout()), &app, SLOT( quit()));
+    foreach(QThread* thread, workerThreads)
+        thread->start();
+    bool done = false;
+    while(!done && watchdog.isActive())
+    {
+        poll.start(100);
+        app.exec();
+        done = true;
+        foreach(QThread* thread, workerThreads)
+            done = done && thread->isFinished();
+    }
+    if(!done)
+    {
+        fprintf(stderr, "Workers did not finish, deadlocked?\n");
+        return 3;
+    }
+
+    int cycles = 0;
+    int failures = 0;
+    int positionUpdates = 0;
+    int satelliteUpdates = 0;
+    for(int i=0; i<workers.size(); ++i)
+    {
+        workerThreads.at(i)->wait();
+        cycles += workers.at(i)->cycles();
+        failures += workers.at(i)->failures();
+        positionUpdates += workers.at(i)->positionUpdates();
+        satelliteUpdates += workers.at(i)->satelliteUpdates();
+        delete workers.at(i);
+        delete workerThreads.at(i);
+    }
+    printf("{\"threads\":%d,\"cycles\":%d,\"failures\":%d,\"position_updates\":%d,"
+           "\"satellite_updates\":%d}\n",
+           workers.size(), cycles, failures, positionUpdates, satelliteUpdates);
+    return failures == 0 && positionUpdates > 0 && satelliteUpdates > 0 ? 0 : 2;
+}
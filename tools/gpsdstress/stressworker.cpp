@@ -0,0 +1,162 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "stressworker.h"
+
+#include <QGeoPositionInfoSource>
+#include <QGeoSatelliteInfoSource>
+#include <QTimer>
+
+StressWorker::StressWorker(const QVariantMap& parameters, int duration, quint32 seed)
+    : _parameters(parameters)
+    , _duration(duration)
+    , _random(seed)
+    , _position(0)
+    , _satellite(0)
+    , _cycles(0)
+    , _failures(0)
+    , _positionUpdates(0)
+    , _satelliteUpdates(0)
+{
+}
+
+int StressWorker::cycles() const
+{
+    return _cycles;
+}
+
+int StressWorker::failures() const
+{
+    return _failures;
+}
+
+int StressWorker::positionUpdates() const
+{
+    return _positionUpdates;
+}
+
+int StressWorker::satelliteUpdates() const
+{
+    return _satelliteUpdates;
+}
+
+void StressWorker::start()
+{
+    _clock.start();
+    cycle();
+}
+
+void StressWorker::cycle()
+{
+    if(_clock.elapsed() >= _duration)
+    {
+        // the sources go in this thread, before the main thread waits for it
+        destroySources();
+        emit finished();
+        return;
+    }
+
+    ++_cycles;
+    switch(_random() % 4)
+    {
+    case 0:
+        destroySources();
+        createSources();
+        break;
+    case 1:
+        if(!_position)
+            createSources();
+        if(_position)
+        {
+            _position->startUpdates();
+            _satellite->startUpdates();
+        }
+        break;
+    case 2:
+        if(!_position)
+            createSources();
+        if(_position)
+        {
+            _position->requestUpdate(5000);
+            _satellite->requestUpdate(5000);
+        }
+        break;
+    default:
+        if(_position)
+        {
+            _position->stopUpdates();
+            _satellite->stopUpdates();
+        }
+        break;
+    }
+    if(_position && (_position->error() != QGeoPositionInfoSource::NoError
+                     || _satellite->error() != QGeoSatelliteInfoSource::NoError))
+    {
+        ++_failures;
+        destroySources();
+    }
+    QTimer::singleShot(int(_random() % 200), this, SLOT( cycle()));
+}
+
+void StressWorker::positionUpdated(const QGeoPositionInfo& info)
+{
+    Q_UNUSED(info);
+    ++_positionUpdates;
+}
+
+void StressWorker::satellitesUpdated(const QList<QGeoSatelliteInfo>& satellites)
+{
+    Q_UNUSED(satellites);
+    ++_satelliteUpdates;
+}
+
+void StressWorker::createSources()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    _position = QGeoPositionInfoSource::createSource("gpsd", _parameters, this);
+    _satellite = QGeoSatelliteInfoSource::createSource("gpsd", _parameters, this);
+#else
+    _position = QGeoPositionInfoSource::createSource("gpsd", this);
+    _satellite = QGeoSatelliteInfoSource::createSource("gpsd", this);
+#endif
+    if(!_position || !_satellite)
+    {
+        ++_failures;
+        destroySources();
+        return;
+    }
+    connect(_position, SIGNAL( positionUpdated(QGeoPositionInfo)),
+            this, SLOT( positionUpdated(QGeoPositionInfo)));
+    connect(_satellite, SIGNAL( satellitesInViewUpdated(QList<QGeoSatelliteInfo>)),
+            this, SLOT( satellitesUpdated(QList<QGeoSatelliteInfo>)));
+}
+
+void StressWorker::destroySources()
+{
+    delete _position;
+    delete _satellite;
+    _position = 0;
+    _satellite = 0;
+}
@@ -0,0 +1,84 @@
+/*
+  The MIT License (MIT)
+
+  Copyright (c) 2016 Jörg Mechnich <joerg.mechnich@gmail.com>
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+  
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+  
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef STRESSWORKER_H
+#define STRESSWORKER_H
+
+#include <QElapsedTimer>
+#include <QGeoPositionInfo>
+#include <QGeoSatelliteInfo>
+#include <QList>
+#include <QObject>
+#include <QVariantMap>
+#include <random>
+
+class QGeoPositionInfoSource;
+class QGeoSatelliteInfoSource;
+
+// Lives in a worker thread and, until the given time is up, cycles
+// through the life of a position and a satellite source in random order
+// and at random intervals: creating, starting or requesting an update,
+// stopping, and destroying them.
+class StressWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    StressWorker(const QVariantMap& parameters, int duration, quint32 seed);
+
+    // counters, to be read once the worker has finished
+    int cycles() const;
+    int failures() const;
+    int positionUpdates() const;
+    int satelliteUpdates() const;
+
+signals:
+    void finished();
+
+public slots:
+    void start();
+
+private slots:
+    void cycle();
+    void positionUpdated(const QGeoPositionInfo& info);
+    void satellitesUpdated(const QList<QGeoSatelliteInfo>& satellites);
+
+private:
+    void createSources();
+    void destroySources();
+
+    QVariantMap _parameters;
+    int _duration;
+    std::mt19937 _random;
+    QElapsedTimer _clock;
+    QGeoPositionInfoSource* _position;
+    QGeoSatelliteInfoSource* _satellite;
+    int _cycles;
+    int _failures;
+    int _positionUpdates;
+    int _satelliteUpdates;
+};
+
+#endif // STRESSWORKER_H